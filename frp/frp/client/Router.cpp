@@ -1,7 +1,6 @@
 #include <frp/client/Router.h>
 #include <frp/threading/Hosting.h>
 #include <frp/threading/Timer.h>
-#include <frp/io/MemoryStream.h>
 #include <frp/net/Socket.h>
 #include <frp/net/IPEndPoint.h>
 #include <frp/collections/Dictionary.h>
@@ -10,9 +9,15 @@
 #include <frp/messages/HandshakeRequest.h>
 #include <frp/transmission/Transmission.h>
 #include <frp/transmission/EncryptorTransmission.h>
+#include <frp/transmission/AeadEncryptorTransmission.h>
 #include <frp/transmission/SslSocketTransmission.h>
 #include <frp/transmission/WebSocketTransmission.h>
 #include <frp/transmission/SslWebSocketTransmission.h>
+#include <frp/transmission/CompressionTransmission.h>
+#include <frp/transmission/ReliableUdpSocket.h>
+#include <frp/transmission/ReliableUdpTransmission.h>
+#include <frp/transmission/DatagramChannel.h>
+#include <frp/messages/WriteToBatch.h>
 
 using frp::collections::Dictionary;
 using frp::net::AddressFamily;
@@ -137,6 +142,8 @@ namespace frp {
                 DatagramPortManager::ReleaseAllDatagramPort();
                 TransmissionManager::ReleaseAllTransmission();
                 RestartTasksManger::CloseAllRestartTasks();
+                frp::collections::Dictionary::ReleaseAllPairs(channels_);
+                batches_.clear();
             }
             frp::threading::ClearTimeout(timeout_);
         }
@@ -173,6 +180,12 @@ namespace frp {
         }
 
         bool Router::MappingEntry::CloseTransmission(const TransmissionPtr& transmission) noexcept {
+            DatagramChannelPtr channel;
+            if (frp::collections::Dictionary::TryRemove(channels_, transmission.get(), channel)) {
+                channel->Close();
+            }
+
+            batches_.erase(transmission.get());
             if (TransmissionManager::CloseTransmission(transmission.get())) {
                 if (RestartTransmission()) {
                     MAPPINGENTRY_LOGF("Disconnect mapping");
@@ -192,11 +205,6 @@ namespace frp {
                 return false;
             }
 
-            std::shared_ptr<boost::asio::ip::tcp::socket> socket = make_shared_object<boost::asio::ip::tcp::socket>(*context);
-            if (!socket) {
-                return false;
-            }
-
             IPEndPoint remoteEP(configuration->IP.data(), configuration->Port);
             if (IPEndPoint::IsInvalid(remoteEP)) {
                 return false;
@@ -206,6 +214,25 @@ namespace frp {
                 return false;
             }
 
+            /* There is nothing to connect over UDP, the SYN of the handshake opens the session on frps. */
+            if (configuration->Protocol == ProtocolType::ProtocolType_ReliableUdp) {
+                const TransmissionPtr transmission = router_->CreateTransmission(context, IPEndPoint::ToEndPoint<boost::asio::ip::udp>(remoteEP));
+                if (!transmission) {
+                    return false;
+                }
+
+                if (!AcceptTransmission(transmission)) {
+                    transmission->Close();
+                    return false;
+                }
+                return true;
+            }
+
+            std::shared_ptr<boost::asio::ip::tcp::socket> socket = make_shared_object<boost::asio::ip::tcp::socket>(*context);
+            if (!socket) {
+                return false;
+            }
+
             boost::system::error_code ec;
             if (remoteEP.GetAddressFamily() == AddressFamily::InterNetwork) {
                 socket->open(boost::asio::ip::tcp::v4(), ec);
@@ -258,11 +285,22 @@ namespace frp {
             if (!transmission) {
                 return false;
             }
+            return AcceptTransmission(transmission);
+        }
+
+        bool Router::MappingEntry::AcceptTransmission(const TransmissionPtr& transmission) noexcept {
+            /* Hand the mapping request over up front, the transmission may send it as TLS 1.3 early data. */
+            bool early_data = false;
+            if (configuration_->Protocols.Ssl.EarlyData) {
+                int length;
+                std::shared_ptr<Byte> packet = CreateHandshakeRequest(length);
+                early_data = packet && transmission->SetEarlyData(packet, 0, length);
+            }
 
             const std::shared_ptr<Reference> reference = GetReference();
             return transmission->HandshakeAsync(frp::transmission::ITransmission::HandshakeType_Client, /* In order to extend the transport layer medium. */
-                [reference, this, transmission](bool handshaked) noexcept {
-                    handshaked = handshaked && HandshakeTransmission(transmission);
+                [reference, this, transmission, early_data](bool handshaked) noexcept {
+                    handshaked = handshaked && HandshakeTransmission(CreateTransmission(transmission), early_data);
                     if (!handshaked) { /* This fails. You need to manually invoke the reconstruction of the transport layer; otherwise, the link will be completely lost. */
                         transmission->Close();
                         RestartTransmission();
@@ -270,21 +308,55 @@ namespace frp {
                 });
         }
 
-        bool Router::MappingEntry::HandshakeTransmission(const TransmissionPtr& transmission) {
+        std::shared_ptr<Byte> Router::MappingEntry::CreateHandshakeRequest(int& length) noexcept {
             frp::messages::HandshakeRequest request;
             request.Name = mapping_.Name;
             request.Type = mapping_.Type;
             request.RemotePort = mapping_.RemotePort;
+            request.Features = configuration_->Protocols.Compression ? frp::messages::HandshakeRequest::HandshakeFeatures_Compression : frp::messages::HandshakeRequest::HandshakeFeatures_None;
+            if (configuration_->Protocols.Datagram && mapping_.Type == MappingType::MappingType_UDP) {
+                request.Features |= frp::messages::HandshakeRequest::HandshakeFeatures_Datagram;
+            }
+
+            if (mapping_.Type == MappingType::MappingType_UDP) {
+                request.Features |= frp::messages::HandshakeRequest::HandshakeFeatures_WriteToBatch;
+            }
 
-            int length;
             std::shared_ptr<Byte> packet = request.Serialize(length);
             if (!packet || length < 1) {
-                return false;
+                return NULL;
+            }
+            return packet;
+        }
+
+        Router::TransmissionPtr Router::MappingEntry::CreateTransmission(const TransmissionPtr& transmission) noexcept {
+            /* Stays plain until frps acknowledges the feature, an older frps just never does. */
+            if (!configuration_->Protocols.Compression) {
+                return transmission;
             }
 
+            std::shared_ptr<frp::transmission::CompressionTransmission> compression = NewReference<frp::transmission::CompressionTransmission>(transmission);
+            if (!compression || !compression->Constructor(compression)) {
+                return transmission;
+            }
+            return compression;
+        }
+
+        bool Router::MappingEntry::HandshakeTransmission(const TransmissionPtr& transmission, bool early_data) {
             const std::shared_ptr<Reference> sreference = GetReference();
             const TransmissionPtr stransmission = transmission;
 
+            /* The request already went out with the TLS handshake. */
+            if (early_data) {
+                return AddTransmission(stransmission);
+            }
+
+            int length;
+            std::shared_ptr<Byte> packet = CreateHandshakeRequest(length);
+            if (!packet) {
+                return false;
+            }
+
             if (!stransmission->WriteAsync(packet, 0, length,
                 [sreference, this, stransmission](bool success) noexcept {
                     Then(stransmission, success);
@@ -329,6 +401,12 @@ namespace frp {
                 break;
             case frp::messages::PacketCommands_Heartbeat:
                 break;
+            case frp::messages::PacketCommands_Datagram:
+                OnHandleDatagram(transmission, *packet);
+                break;
+            case frp::messages::PacketCommands_WriteToBatch:
+                OnHandleWriteToBatch(transmission, *packet);
+                break;
             default:
                 return false;
             }
@@ -377,7 +455,7 @@ namespace frp {
                 return false;
             }
 
-            DatagramPortPtr datagramPort = AllocDatagramPort(remoteEP,
+            DatagramPortPtr datagramPort = AllocDatagramPort(remoteEP, configuration_->Udp.Sessions,
                 [this](const boost::asio::ip::udp::endpoint& remoteEP) noexcept {
                     return NewReference<DatagramPort>(CastReference<MappingEntry>(GetReference()), remoteEP);
                 });
@@ -388,6 +466,123 @@ namespace frp {
             return datagramPort->SendToLocalClientAsync(packet.Buffer.get(), packet.Offset, packet.Length);
         }
 
+        bool Router::MappingEntry::OnHandleDatagram(const TransmissionPtr& transmission, frp::messages::Packet& packet) noexcept {
+            if (!configuration_->Protocols.Datagram || mapping_.Type != MappingType::MappingType_UDP) {
+                return false;
+            }
+
+            if (packet.Offset < 0 || packet.Length != frp::transmission::DatagramChannel::SECRET_SIZE || packet.Id == 0) {
+                return false;
+            }
+
+            IPEndPoint serverEP(configuration_->IP.data(), configuration_->Port);
+            if (IPEndPoint::IsInvalid(serverEP)) {
+                return false;
+            }
+
+            /* A socket of its own per transmission, frps tells the sessions apart by their id and finds the NAT binding from the probes. */
+            boost::system::error_code ec;
+            std::shared_ptr<boost::asio::ip::udp::socket> socket = make_shared_object<boost::asio::ip::udp::socket>(*hosting_->GetContext());
+            if (!socket) {
+                return false;
+            }
+
+            if (serverEP.GetAddressFamily() == AddressFamily::InterNetwork) {
+                socket->open(boost::asio::ip::udp::v4(), ec);
+            }
+            else {
+                socket->open(boost::asio::ip::udp::v6(), ec);
+            }
+
+            if (ec) {
+                return false;
+            }
+
+            const std::string secret((char*)packet.Buffer.get() + packet.Offset, packet.Length);
+            const DatagramChannelPtr channel = NewReference<frp::transmission::DatagramChannel>(hosting_, socket, (UInt32)packet.Id, secret, true, configuration_->Protocols.Fec);
+            if (!channel) {
+                frp::net::Socket::Closesocket(socket);
+                return false;
+            }
+
+            const TransmissionPtr stransmission = transmission;
+            const std::shared_ptr<Reference> sreference = GetReference();
+            if (!channel->Open(IPEndPoint::ToEndPoint<boost::asio::ip::udp>(serverEP),
+                [sreference, this, stransmission](const std::shared_ptr<frp::messages::Packet>& packet) noexcept {
+                    if (packet->Command == frp::messages::PacketCommands::PacketCommands_WriteTo) {
+                        OnHandleWriteTo(stransmission, *packet);
+                    }
+                })) {
+                channel->Close();
+                frp::net::Socket::Closesocket(socket);
+                return false;
+            }
+
+            DatagramChannelPtr previous;
+            if (frp::collections::Dictionary::TryRemove(channels_, transmission.get(), previous)) {
+                previous->Close();
+            }
+
+            if (!frp::collections::Dictionary::TryAdd(channels_, transmission.get(), channel)) {
+                channel->Close();
+                return false;
+            }
+            return true;
+        }
+
+        bool Router::MappingEntry::OnHandleWriteToBatch(const TransmissionPtr& transmission, frp::messages::Packet& packet) noexcept {
+            if (mapping_.Type != MappingType::MappingType_UDP) {
+                return false;
+            }
+
+            /* The first batch from frps, usually the empty one right after the handshake, lets frpc batch in turn. */
+            WriteToBatchPtr batch;
+            if (!frp::collections::Dictionary::TryGetValue(batches_, transmission.get(), batch)) {
+                batch = make_shared_object<frp::messages::WriteToBatch>();
+                if (batch) {
+                    batches_[transmission.get()] = batch;
+                }
+            }
+
+            return frp::messages::WriteToBatch::Unpack(packet,
+                [this, &transmission](frp::messages::Packet& datagram) noexcept {
+                    OnHandleWriteTo(transmission, datagram);
+                });
+        }
+
+        bool Router::MappingEntry::WriteToBatchAsync(const TransmissionPtr& transmission, const WriteToBatchPtr& batch, const void* buffer, int length, const boost::asio::ip::udp::endpoint& endpoint) noexcept {
+            if (!batch->Add(buffer, length, endpoint)) {
+                if (!FlushBatchAsync(transmission, batch) || !batch->Add(buffer, length, endpoint)) {
+                    return false;
+                }
+            }
+
+            /* The first datagram of a batch schedules its flush, whatever else arrives in the same turn of the event loop rides along. */
+            if (batch->GetCount() == 1) {
+                const std::shared_ptr<Reference> reference = GetReference();
+                boost::asio::post(*hosting_->GetContext(),
+                    [reference, this, transmission, batch]() noexcept {
+                        FlushBatchAsync(transmission, batch);
+                    });
+            }
+            return true;
+        }
+
+        bool Router::MappingEntry::FlushBatchAsync(const TransmissionPtr& transmission, const WriteToBatchPtr& batch) noexcept {
+            int packet_size;
+            const std::shared_ptr<Byte> packet = batch->Detach(packet_size);
+            if (!packet) {
+                return true;
+            }
+
+            const std::shared_ptr<Reference> reference = GetReference();
+            return Then(transmission,
+                transmission->WriteAsync(packet, 0, packet_size,
+                    [reference, this, transmission](bool success) noexcept {
+                        Then(transmission, success);
+                    }));
+        }
+
         bool Router::MappingEntry::SendKeepAlivePacket(const TransmissionPtr& transmission) noexcept {
             frp::messages::Packet packet;
             packet.Command = frp::messages::PacketCommands::PacketCommands_Heartbeat;
@@ -417,17 +612,26 @@ namespace frp {
                 transmission = NewReference2<frp::transmission::ITransmission, frp::transmission::SslSocketTransmission>(hosting_, context, socket,
                     configuration_->Protocols.Ssl.VerifyPeer,
                     configuration_->Protocols.Ssl.Host,
-                    configuration_->Protocols.Ssl.Ciphersuites);
+                    configuration_->Protocols.Ssl.Ciphersuites,
+                    configuration_->Protocols.Ssl.Ktls);
+            }
+            elif(configuration_->Protocol == AppConfiguration::ProtocolType_Encryptor && configuration_->Protocols.Encryptor.Aead) {
+                transmission = NewReference2<frp::transmission::ITransmission, frp::transmission::AeadEncryptorTransmission>(hosting_, context, socket,
+                    configuration_->Protocols.Encryptor.Method,
+                    configuration_->Protocols.Encryptor.Password,
+                    configuration_->Protocols.Encryptor.Pipeline);
             }
             elif(configuration_->Protocol == AppConfiguration::ProtocolType_Encryptor) {
                 transmission = NewReference2<frp::transmission::ITransmission, frp::transmission::EncryptorTransmission>(hosting_, context, socket,
                     configuration_->Protocols.Encryptor.Method,
-                    configuration_->Protocols.Encryptor.Password);
+                    configuration_->Protocols.Encryptor.Password,
+                    configuration_->Protocols.Encryptor.Pipeline);
             }
             elif(configuration_->Protocol == AppConfiguration::ProtocolType_WebSocket) {
                 transmission = NewReference2<frp::transmission::ITransmission, frp::transmission::WebSocketTransmission>(hosting_, context, socket,
                     configuration_->Protocols.WebSocket.Host,
-                    configuration_->Protocols.WebSocket.Path);
+                    configuration_->Protocols.WebSocket.Path,
+                    configuration_->Protocols.WebSocket.Compression);
             }
             elif(configuration_->Protocol == AppConfiguration::ProtocolType_WebSocket_SSL ||
                 configuration_->Protocol == AppConfiguration::ProtocolType_WebSocket_TLS) {
@@ -435,6 +639,7 @@ namespace frp {
                     configuration_->Protocols.Ssl.VerifyPeer,
                     configuration_->Protocols.WebSocket.Host,
                     configuration_->Protocols.WebSocket.Path,
+                    configuration_->Protocols.WebSocket.Compression,
                     configuration_->Protocols.Ssl.Ciphersuites);
             }
             else {
@@ -443,6 +648,32 @@ namespace frp {
             return transmission->Constructor(transmission);
         }
 
+        Router::TransmissionPtr Router::CreateTransmission(const std::shared_ptr<boost::asio::io_context>& context, const boost::asio::ip::udp::endpoint& remoteEP) noexcept {
+            std::shared_ptr<frp::transmission::ReliableUdpSocket> socket = NewReference<frp::transmission::ReliableUdpSocket>(context, configuration_->Protocols.ReliableUdp.Loss);
+            if (!socket) {
+                return NULL;
+            }
+
+            /* Every transmission has a socket of its own, so a session never shares its fate with another. */
+            boost::asio::ip::address address = remoteEP.address().is_v4() ? boost::asio::ip::address(boost::asio::ip::address_v4::any()) : boost::asio::ip::address(boost::asio::ip::address_v6::any());
+            if (!socket->Open(address, 0, NULL)) {
+                socket->Close();
+                return NULL;
+            }
+
+            UInt32 conv = frp::transmission::ReliableUdpTransmission::NewConversation();
+            std::shared_ptr<frp::transmission::ReliableUdpTransmission> transmission = NewReference<frp::transmission::ReliableUdpTransmission>(hosting_, context, socket,
+                conv,
+                remoteEP,
+                configuration_->Protocols.ReliableUdp,
+                true);
+            if (!transmission || !socket->AddTransmission(conv, transmission)) {
+                socket->Close();
+                return NULL;
+            }
+            return transmission->Constructor(transmission);
+        }
+
         Router::Connection::Connection(
             const std::shared_ptr<MappingEntry>&  entry,
             const TransmissionPtr&                transmission,
@@ -722,14 +953,15 @@ namespace frp {
     
         Router::DatagramPort::DatagramPort(const std::shared_ptr<MappingEntry>& entry, boost::asio::ip::udp::endpoint remoteEP) noexcept
             : disposed_(false)
-            , onlydns_(0)
+            , packets_(0)
             , entry_(entry)
             , hosting_(entry->GetHosting())
             , context_(hosting_->GetContext())
             , configuration_(entry->GetConfiguration())
             , buffer_(hosting_->GetBuffer())
             , socket_(*context_)
-            , remoteEP_(remoteEP) {
+            , remoteEP_(remoteEP)
+            , batch_(socket_, configuration_->Udp.Batch, configuration_->Udp.Gso, configuration_->Udp.Queue) {
             const MappingConfiguration& mapping = entry->GetMappingConfiguration();
 
             boost::system::error_code ec;
@@ -771,6 +1003,10 @@ namespace frp {
                 return false;
             }
 
+            if (!batch_.Open()) {
+                return false;
+            }
+
             return Timeout() && ForwardedToFrpServerAsync();
         }
 
@@ -816,9 +1052,11 @@ namespace frp {
                         return;
                     }
 
+                    /* Until the peer sends a second datagram the flow counts as one shot (a query, a probe, a scan) and idles out after udp.timeout. */
+                    const MappingConfiguration& mapping = entry_->GetMappingConfiguration();
                     UInt64 diff = now - last;
-                    UInt64 timeout = onlydns_ == 1 ? 
-                        DynamicNamespaceQueryTimeout : 
+                    UInt64 timeout = packets_ < 2 || mapping.LocalPort == DynamicNamespaceQueryPort ?
+                        configuration_->Udp.Timeout :
                         configuration_->Inactive.Timeout;
 
                     timeout *= 1000;
@@ -842,22 +1080,24 @@ namespace frp {
                 return false;
             }
 
-            boost::system::error_code ec;
-            socket_.send_to(boost::asio::buffer((Byte*)buffer + offset, length), localEP_, 0, ec);
+            /* The replies of one turn of the event loop leave together in one sendmmsg, one GSO send when they are alike, what the socket
+             * cannot take right now waits in the queue for it to turn writable.
+             */
+            int queued = batch_.SendTo((Byte*)buffer + offset, length, localEP_);
+            if (queued == 1) {
+                std::shared_ptr<Reference> reference = GetReference();
+                boost::asio::post(*context_,
+                    [reference, this]() noexcept {
+                        batch_.FlushAsync(reference);
+                    });
+            }
 
-            bool success = ec ? false : true;
-            if (success) {
-                const MappingConfiguration& mapping = entry_->GetMappingConfiguration();
-                if (mapping.LocalPort == DynamicNamespaceQueryPort) {
-                    int localtion = 0;
-                    onlydns_.compare_exchange_weak(localtion, 1);
-                }
-                else {
-                    onlydns_.exchange(2);
-                }
+            /* A full queue drops the datagram like a congested link would, the flow itself stays up. */
+            if (queued > 0) {
+                packets_++;
                 last_ = hosting_->CurrentMillisec();
             }
-            return success;
+            return queued >= 0;
         }
 
         bool Router::DatagramPort::ForwardedToFrpServerAsync() noexcept {
@@ -866,6 +1106,10 @@ namespace frp {
                 return false;
             }
 
+            if (batch_.IsBatch()) {
+                return ForwardedToFrpServerBatchAsync();
+            }
+
             std::shared_ptr<Reference> reference = GetReference();
             socket_.async_receive_from(boost::asio::buffer(buffer_.get(), frp::threading::Hosting::BufferSize), endpoint_,
                 [reference, this](const boost::system::error_code& ec, std::size_t sz) noexcept {
@@ -890,6 +1134,7 @@ namespace frp {
                         }
 
                         /* An attempt to continue pulling up asynchronously waiting for forwarding to the frp server failed. */
+                        entry_->ActiveDatagramPort(remoteEP_);
                         success = ForwardedToFrpServerAsync();
                     } while (0); 
 
@@ -901,20 +1146,70 @@ namespace frp {
             return true;
         }
 
+        bool Router::DatagramPort::ForwardedToFrpServerBatchAsync() noexcept {
+            std::shared_ptr<Reference> reference = GetReference();
+            socket_.async_wait(boost::asio::ip::udp::socket::wait_read,
+                [reference, this](const boost::system::error_code& ec) noexcept {
+                    /* Everything already queued on the socket is drained in one go, each datagram still goes to the frp server on its own. */
+                    bool success = ec != boost::system::errc::operation_canceled;
+                    if (success && !ec) {
+                        success = batch_.ReceiveFrom(
+                            [this](Byte* buffer, int length, const boost::asio::ip::udp::endpoint& endpoint) noexcept {
+                                return SendToFrpServerAsync(buffer, length);
+                            });
+                        if (success) {
+                            entry_->ActiveDatagramPort(remoteEP_);
+                            success = ForwardedToFrpServerAsync();
+                        }
+                    }
+
+                    /* If the current traffic forwarding operation fails, you need to disable dynamic port mapping. */
+                    if (!success) {
+                        Close();
+                    }
+                });
+            return true;
+        }
+
         bool Router::DatagramPort::SendToFrpServerAsync(const void* buffer, int length) noexcept {
-            const TransmissionPtr transmission = entry_->GetTransmission();
+            /* One flow, one transmission, so its datagrams are not reordered across the concurrent transmissions. */
+            const TransmissionPtr transmission = entry_->GetTransmission(frp::net::IPEndPoint::GetHashCode(remoteEP_));
             if (!transmission) {
                 return false;
             }
 
-            frp::io::MemoryStream messages;
-            if (!frp::messages::Packet::PackWriteTo(messages, buffer, 0, length, remoteEP_)) {
+            /* Straight over UDP while frps answers there, otherwise in band as before. */
+            MappingEntry::DatagramChannelPtr channel;
+            if (frp::collections::Dictionary::TryGetValue(entry_->channels_, transmission.get(), channel) && channel->WriteTo(buffer, length, remoteEP_)) {
+                last_ = hosting_->CurrentMillisec();
+                return true;
+            }
+
+            /* Small datagrams share frames once frps acknowledged batches, a large one first flushes what is queued to keep a flow in order. */
+            MappingEntry::WriteToBatchPtr batch;
+            if (frp::collections::Dictionary::TryGetValue(entry_->batches_, transmission.get(), batch)) {
+                if (frp::messages::WriteToBatch::CanBatch(length)) {
+                    bool success = entry_->WriteToBatchAsync(transmission, batch, buffer, length, remoteEP_);
+                    if (success) {
+                        last_ = hosting_->CurrentMillisec();
+                    }
+                    return success;
+                }
+
+                if (!entry_->FlushBatchAsync(transmission, batch)) {
+                    return false;
+                }
+            }
+
+            int packet_size;
+            const std::shared_ptr<Byte> packet = frp::messages::Packet::PackWriteTo(buffer, 0, length, remoteEP_, packet_size);
+            if (!packet) {
                 return false;
             }
 
             const std::shared_ptr<Reference> reference = GetReference();
             return Then(transmission,
-                transmission->WriteAsync(messages.GetBuffer(), 0, messages.GetPosition(),
+                transmission->WriteAsync(packet, 0, packet_size,
                     [reference, this, transmission](bool success) noexcept {
                         if (Then(transmission, success)) {
                             last_ = hosting_->CurrentMillisec();
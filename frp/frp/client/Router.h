@@ -2,6 +2,7 @@
 
 #include <frp/IDisposable.h>
 #include <frp/threading/Hosting.h>
+#include <frp/net/DatagramBatch.h>
 #include <frp/transmission/ITransmission.h>
 #include <frp/configuration/AppConfiguration.h>
 #include <frp/collections/RestartTasksManger.h>
@@ -16,6 +17,11 @@ namespace frp {
     namespace messages {
         class Packet;
         class HandshakeRequest;
+        class WriteToBatch;
+    }
+
+    namespace transmission {
+        class DatagramChannel;
     }
 
     namespace client {
@@ -38,8 +44,7 @@ namespace frp {
             class DatagramPort final : public IDisposable {
                 friend class MappingEntry;
 
-                /* DNS query only-port 53 timeout is 3 seconds. */
-                static const int                                            DynamicNamespaceQueryTimeout = 3;
+                /* A DNS port only ever sees one shot flows, each query comes from a port of its own. */
                 static const int                                            DynamicNamespaceQueryPort = 53;
 
             public:
@@ -56,12 +61,13 @@ namespace frp {
                 void                                                        ClearTimeout() noexcept;
                 bool                                                        Timeout() noexcept;
                 bool                                                        ForwardedToFrpServerAsync() noexcept;
+                bool                                                        ForwardedToFrpServerBatchAsync() noexcept;
                 bool                                                        SendToFrpServerAsync(const void* buffer, int length) noexcept;
 
             private:
                 std::atomic<bool>                                           disposed_;
                 UInt64                                                      last_;
-                std::atomic<int>                                            onlydns_;
+                UInt32                                                      packets_;
                 std::shared_ptr<MappingEntry>                               entry_;
                 std::shared_ptr<frp::threading::Hosting>                    hosting_;
                 std::shared_ptr<boost::asio::io_context>                    context_;
@@ -71,6 +77,7 @@ namespace frp {
                 boost::asio::ip::udp::endpoint                              endpoint_;
                 boost::asio::ip::udp::endpoint                              localEP_;
                 boost::asio::ip::udp::endpoint                              remoteEP_;
+                frp::net::DatagramBatch                                     batch_;
                 std::shared_ptr<boost::asio::deadline_timer>                timeout_;
             };
             class Connection final : public IDisposable {
@@ -141,6 +148,10 @@ namespace frp {
             class MappingEntry final : public IDisposable, public TransmissionManager, public DatagramPortManager, public RestartTasksManger {
                 friend class DatagramPort;
                 friend class Connection;
+                typedef std::shared_ptr<frp::transmission::DatagramChannel> DatagramChannelPtr;
+                typedef std::unordered_map<void*, DatagramChannelPtr>       DatagramChannelTable;
+                typedef std::shared_ptr<frp::messages::WriteToBatch>        WriteToBatchPtr;
+                typedef std::unordered_map<void*, WriteToBatchPtr>          WriteToBatchTable;
 
             public:
                 MappingEntry(const std::shared_ptr<Router>& router, const MappingConfiguration& mapping) noexcept;
@@ -164,9 +175,12 @@ namespace frp {
 
             private:
                 bool                                                        RestartTransmission() noexcept;
-                bool                                                        HandshakeTransmission(const TransmissionPtr& transmission);
+                bool                                                        HandshakeTransmission(const TransmissionPtr& transmission, bool early_data);
+                TransmissionPtr                                             CreateTransmission(const TransmissionPtr& transmission) noexcept;
+                std::shared_ptr<Byte>                                       CreateHandshakeRequest(int& length) noexcept;
                 bool                                                        ConnectTransmission(const std::shared_ptr<AppConfiguration>& configuration, const std::shared_ptr<frp::threading::Hosting>& hosting) noexcept;
                 bool                                                        AcceptTransmission(const std::shared_ptr<boost::asio::io_context>& context, const std::shared_ptr<boost::asio::ip::tcp::socket>& socket) noexcept;
+                bool                                                        AcceptTransmission(const TransmissionPtr& transmission) noexcept;
 
             private:
                 bool                                                        Then(const TransmissionPtr& transmission, bool success) noexcept;
@@ -182,6 +196,12 @@ namespace frp {
                 bool                                                        OnHandleDisconnect(const TransmissionPtr& transmission, int id) noexcept;
                 bool                                                        OnHandleWrite(const TransmissionPtr& transmission, frp::messages::Packet& packet) noexcept;
                 bool                                                        OnHandleWriteTo(const TransmissionPtr& transmission, frp::messages::Packet& packet) noexcept;
+                bool                                                        OnHandleDatagram(const TransmissionPtr& transmission, frp::messages::Packet& packet) noexcept;
+                bool                                                        OnHandleWriteToBatch(const TransmissionPtr& transmission, frp::messages::Packet& packet) noexcept;
+
+            private:
+                bool                                                        WriteToBatchAsync(const TransmissionPtr& transmission, const WriteToBatchPtr& batch, const void* buffer, int length, const boost::asio::ip::udp::endpoint& endpoint) noexcept;
+                bool                                                        FlushBatchAsync(const TransmissionPtr& transmission, const WriteToBatchPtr& batch) noexcept;
 
             public:
                 bool                                                        AddTransmission(const TransmissionPtr& transmission) noexcept;
@@ -194,6 +214,8 @@ namespace frp {
                 std::shared_ptr<AppConfiguration>                           configuration_;
                 std::shared_ptr<frp::threading::Hosting>                    hosting_;
                 std::shared_ptr<boost::asio::deadline_timer>                timeout_;
+                DatagramChannelTable                                        channels_;
+                WriteToBatchTable                                           batches_;
             };
             typedef std::shared_ptr<MappingEntry>                           MappingEntryPtr;
             typedef std::unordered_map<void*, MappingEntryPtr>              MappingEntryTable;
@@ -216,6 +238,7 @@ namespace frp {
 
         protected:
             virtual TransmissionPtr                                         CreateTransmission(const std::shared_ptr<boost::asio::io_context>& context, const std::shared_ptr<boost::asio::ip::tcp::socket>& socket) noexcept;
+            virtual TransmissionPtr                                         CreateTransmission(const std::shared_ptr<boost::asio::io_context>& context, const boost::asio::ip::udp::endpoint& remoteEP) noexcept;
 
         private:
             std::atomic<bool>                                               disposed_;
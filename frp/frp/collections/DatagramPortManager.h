@@ -1,7 +1,8 @@
 #pragma once
 
 #include <frp/Reference.h>
-#include <frp/collections/Dictionary.h>
+#include <frp/net/EndPointKey.h>
+#include <frp/collections/FlatTable.h>
 
 namespace frp {
     namespace collections {
@@ -12,55 +13,127 @@ namespace frp {
             typedef std::shared_ptr<DatagramPort>                       DatagramPortPtr;
 
         private:
-            typedef std::unordered_map<std::string, DatagramPortPtr>    DatagramPortTable;
+            typedef frp::net::EndPointKey                               DatagramPortKey;
+            struct DatagramPortEntry {
+                DatagramPortKey                                         Key;
+                DatagramPortPtr                                         Port;
+                bool                                                    Established;
+            };
+            typedef std::list<DatagramPortEntry>                        DatagramPortList;
+            typedef typename DatagramPortList::iterator                 DatagramPortNode;
+            typedef FlatTable<DatagramPortKey, DatagramPortNode>        DatagramPortTable;
 
         private:
+            /* Looked up for every datagram, so the key is a plain value rather than the formatted address. */
             template<class TProtocol>
-            inline static std::string                                   ToKey(const boost::asio::ip::basic_endpoint<TProtocol>& endpoint) noexcept {
-                return endpoint.address().to_string() + ":" + std::to_string(endpoint.port());
+            inline static DatagramPortKey                               ToKey(const boost::asio::ip::basic_endpoint<TProtocol>& endpoint) noexcept {
+                return DatagramPortKey::From(endpoint);
             }
 
         protected:
+            inline int                                                  GetDatagramPortCount() noexcept {
+                return datagramPorts_.Count();
+            }
             inline bool                                                 ReleaseDatagramPort(const boost::asio::ip::udp::endpoint& endpoint) noexcept {
-                DatagramPortPtr datagramPort;
-                if (!Dictionary::TryRemove(datagramPorts_, ToKey(endpoint), datagramPort)) {
-                    return false;
-                }
-
-                datagramPort->Close();
-                return true;
+                return ReleaseDatagramPort(ToKey(endpoint));
             }
             inline void                                                 ReleaseAllDatagramPort() noexcept {
-                Dictionary::ReleaseAllPairs(datagramPorts_);
+                std::vector<DatagramPortPtr> releases;
+                releases.reserve(datagramPorts_.Count());
+                for (DatagramPortList* list : { &probation_, &established_ }) {
+                    typename DatagramPortList::iterator tail = list->begin();
+                    typename DatagramPortList::iterator endl = list->end();
+                    for (; tail != endl; tail++) {
+                        releases.push_back(std::move(tail->Port));
+                    }
+                    list->clear();
+                }
+                datagramPorts_.Clear();
+
+                for (DatagramPortPtr& datagramPort : releases) {
+                    datagramPort->Close();
+                }
             }
             inline DatagramPortPtr                                      GetDatagramPort(const boost::asio::ip::udp::endpoint& endpoint) noexcept {
-                DatagramPortPtr datagramPort;
-                Dictionary::TryGetValue(datagramPorts_, ToKey(endpoint), datagramPort);
-                return std::move(datagramPort);
+                DatagramPortNode* node = datagramPorts_.Find(ToKey(endpoint));
+                return NULL != node ? (*node)->Port : NULL;
+            }
+            /* Moves the port to the recent end of its list, the eviction takes the other end. */
+            inline bool                                                 ActiveDatagramPort(const boost::asio::ip::udp::endpoint& endpoint) noexcept {
+                DatagramPortNode* node = datagramPorts_.Find(ToKey(endpoint));
+                if (NULL == node) {
+                    return false;
+                }
+
+                DatagramPortList& list = (*node)->Established ? established_ : probation_;
+                list.splice(list.end(), list, *node);
+                return true;
             }
 
         protected:
+            /* At most sessions ports, each new flow first in probation and only established once the peer sent again, so when full
+             * the least recently active of the one shot flows goes first, and a scan of the public port cannot flush the established ones.
+             */
             template<class Creator>
-            inline DatagramPortPtr                                      AllocDatagramPort(const boost::asio::ip::udp::endpoint& endpoint, Creator&& creator) noexcept {
-                std::string key = ToKey(endpoint);
-                std::shared_ptr<DatagramPort> datagramPort;
-                if (!Dictionary::TryGetValue(datagramPorts_, key, datagramPort)) {
-                    datagramPort = creator(endpoint);
-                    if (!datagramPort) {
-                        return NULL;
+            inline DatagramPortPtr                                      AllocDatagramPort(const boost::asio::ip::udp::endpoint& endpoint, int sessions, Creator&& creator) noexcept {
+                DatagramPortKey key = ToKey(endpoint);
+                DatagramPortNode* node = datagramPorts_.Find(key);
+                if (NULL != node) {
+                    DatagramPortNode position = *node;
+                    if (position->Established) {
+                        established_.splice(established_.end(), established_, position);
                     }
-
-                    bool success = datagramPort->Open() && Dictionary::TryAdd(datagramPorts_, key, datagramPort);
-                    if (!success) {
-                        datagramPort->Close();
-                        return NULL;
+                    else {
+                        position->Established = true;
+                        established_.splice(established_.end(), probation_, position);
                     }
+                    return position->Port;
+                }
+
+                while (datagramPorts_.Count() > 0 && datagramPorts_.Count() >= (std::size_t)std::max<int>(1, sessions)) {
+                    DatagramPortList& victims = probation_.empty() ? established_ : probation_;
+                    DatagramPortKey victim = victims.front().Key;
+                    ReleaseDatagramPort(victim);
+                }
+
+                DatagramPortPtr datagramPort = creator(endpoint);
+                if (!datagramPort) {
+                    return NULL;
+                }
+
+                if (!datagramPort->Open()) {
+                    datagramPort->Close();
+                    return NULL;
+                }
+
+                DatagramPortEntry entry = { key, datagramPort, false };
+                DatagramPortNode position = probation_.insert(probation_.end(), entry);
+                if (!datagramPorts_.TryAdd(key, position)) {
+                    probation_.erase(position);
+                    datagramPort->Close();
+                    return NULL;
                 }
                 return datagramPort;
             }
 
+        private:
+            inline bool                                                 ReleaseDatagramPort(const DatagramPortKey& key) noexcept {
+                DatagramPortNode position;
+                if (!datagramPorts_.TryRemove(key, position)) {
+                    return false;
+                }
+
+                DatagramPortPtr datagramPort = std::move(position->Port);
+                (position->Established ? established_ : probation_).erase(position);
+
+                datagramPort->Close();
+                return true;
+            }
+
         private:
             DatagramPortTable                                           datagramPorts_;
+            DatagramPortList                                            probation_;
+            DatagramPortList                                            established_;
         };
     }
 }
\ No newline at end of file
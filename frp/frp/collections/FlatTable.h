@@ -0,0 +1,190 @@
+#pragma once
+
+#include <frp/stdafx.h>
+
+namespace frp {
+    namespace collections {
+        /* Open addressing with linear probing in one array of slots, removal shifts the followers back instead of leaving tombstones,
+         * so a lookup is a hash, a mask and a short scan over adjacent memory, and nothing is allocated unless the table grows.
+         */
+        template<class TKey, class TValue, class THash = std::hash<TKey> >
+        class FlatTable final {
+        private:
+            struct Slot {
+                TKey                                                    Key;
+                TValue                                                  Value;
+                std::size_t                                             Hash;
+                bool                                                    Used;
+            };
+            typedef std::vector<Slot>                                   SlotList;
+
+        public:
+            static const std::size_t                                    MIN_CAPACITY = 16;
+
+        public:
+            inline FlatTable() noexcept
+                : count_(0) {
+
+            }
+
+        public:
+            inline std::size_t                                          Count() const noexcept {
+                return count_;
+            }
+            inline TValue*                                              Find(const TKey& key) noexcept {
+                if (count_ == 0) {
+                    return NULL;
+                }
+
+                std::size_t mask = slots_.size() - 1;
+                std::size_t hash = THash()(key);
+                for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+                    Slot& slot = slots_[i];
+                    if (!slot.Used) {
+                        return NULL;
+                    }
+                    elif(slot.Hash == hash && slot.Key == key) {
+                        return &slot.Value;
+                    }
+                }
+            }
+            inline bool                                                 ContainsKey(const TKey& key) noexcept {
+                return NULL != Find(key);
+            }
+            inline bool                                                 TryGetValue(const TKey& key, TValue& value) noexcept {
+                TValue* p = Find(key);
+                if (NULL == p) {
+                    return false;
+                }
+
+                value = *p;
+                return true;
+            }
+            inline bool                                                 TryAdd(const TKey& key, const TValue& value) noexcept {
+                if (ContainsKey(key)) {
+                    return false;
+                }
+
+                /* Kept at most three quarters full, the probe sequences stay short. */
+                if ((count_ + 1) << 2 > slots_.size() * 3) {
+                    Rehash(std::max<std::size_t>(MIN_CAPACITY, slots_.size() << 1));
+                }
+
+                Insert(THash()(key), key, value);
+                count_++;
+                return true;
+            }
+            inline bool                                                 TryRemove(const TKey& key, TValue& value) noexcept {
+                if (count_ == 0) {
+                    return false;
+                }
+
+                std::size_t mask = slots_.size() - 1;
+                std::size_t hash = THash()(key);
+                std::size_t i = hash & mask;
+                for (;; i = (i + 1) & mask) {
+                    Slot& slot = slots_[i];
+                    if (!slot.Used) {
+                        return false;
+                    }
+                    elif(slot.Hash == hash && slot.Key == key) {
+                        break;
+                    }
+                }
+
+                value = std::move(slots_[i].Value);
+                for (std::size_t j = (i + 1) & mask;; j = (j + 1) & mask) {
+                    Slot& next = slots_[j];
+                    if (!next.Used) {
+                        break;
+                    }
+
+                    /* A follower moves into the hole unless its home lies between the hole and itself. */
+                    std::size_t home = next.Hash & mask;
+                    if (((j - home) & mask) >= ((j - i) & mask)) {
+                        slots_[i] = std::move(next);
+                        i = j;
+                    }
+                }
+
+                Slot& hole = slots_[i];
+                hole.Key = TKey();
+                hole.Value = TValue();
+                hole.Used = false;
+                count_--;
+                return true;
+            }
+            inline bool                                                 TryRemove(const TKey& key) noexcept {
+                TValue value;
+                return TryRemove(key, value);
+            }
+            inline void                                                 Clear() noexcept {
+                slots_.clear();
+                count_ = 0;
+            }
+            template<typename WhileHandler>
+            inline void                                                 WhileAllPairs(WhileHandler&& handler) noexcept {
+                typename SlotList::iterator tail = slots_.begin();
+                typename SlotList::iterator endl = slots_.end();
+                for (; tail != endl; tail++) {
+                    if (tail->Used) {
+                        handler(tail->Key, tail->Value);
+                    }
+                }
+            }
+            /* Empties the table first and closes afterwards, a close that comes back into the table finds it consistent. */
+            template<typename CloseHandler>
+            inline int                                                  ReleaseAllPairs(CloseHandler&& handler) noexcept {
+                std::vector<TValue> releases;
+                releases.reserve(count_);
+
+                typename SlotList::iterator tail = slots_.begin();
+                typename SlotList::iterator endl = slots_.end();
+                for (; tail != endl; tail++) {
+                    if (tail->Used) {
+                        releases.push_back(std::move(tail->Value));
+                    }
+                }
+                Clear();
+
+                std::size_t length = releases.size();
+                for (std::size_t index = 0; index < length; index++) {
+                    TValue p = std::move(releases[index]);
+                    handler(p);
+                }
+                return length;
+            }
+
+        private:
+            inline void                                                 Insert(std::size_t hash, const TKey& key, const TValue& value) noexcept {
+                std::size_t mask = slots_.size() - 1;
+                for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+                    Slot& slot = slots_[i];
+                    if (!slot.Used) {
+                        slot.Key = key;
+                        slot.Value = value;
+                        slot.Hash = hash;
+                        slot.Used = true;
+                        break;
+                    }
+                }
+            }
+            inline void                                                 Rehash(std::size_t capacity) noexcept {
+                SlotList slots(capacity);
+                slots_.swap(slots);
+
+                typename SlotList::iterator tail = slots.begin();
+                typename SlotList::iterator endl = slots.end();
+                for (; tail != endl; tail++) {
+                    if (tail->Used) {
+                        Insert(tail->Hash, tail->Key, std::move(tail->Value));
+                    }
+                }
+            }
+
+        private:
+            SlotList                                                    slots_;
+            std::size_t                                                 count_;
+        };
+    }
+}
\ No newline at end of file
@@ -36,6 +36,27 @@ namespace frp {
                 transmissions_.push_back(transmission);
                 return transmission;
             }
+            inline TransmissionPtr                                      GetTransmission(std::size_t hash) noexcept {
+                /* Rendezvous hashing: the transmission scoring highest for the flow carries it, so a flow keeps its transmission and its order,
+                 * and when one goes away only the flows it carried move on, each to its runner-up.
+                 */
+                TransmissionPtr* best = NULL;
+                UInt64 best_score = 0;
+
+                typename TransmissionList::iterator tail = transmissions_.begin();
+                typename TransmissionList::iterator endl = transmissions_.end();
+                for (; tail != endl; tail++) {
+                    UInt64 score = (UInt64)hash ^ (UInt64)(std::uintptr_t)tail->get();
+                    score = (score ^ (score >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                    score = (score ^ (score >> 27)) * 0x94d049bb133111ebULL;
+                    score = score ^ (score >> 31);
+                    if (NULL == best || score > best_score) {
+                        best = &*tail;
+                        best_score = score;
+                    }
+                }
+                return NULL != best ? *best : NULL;
+            }
             inline TransmissionPtr                                      GetBestTransmission() noexcept {
                 typename TransmissionList::iterator tail = transmissions_.begin();
                 typename TransmissionList::iterator endl = transmissions_.end();
@@ -1,9 +1,11 @@
 #include <frp/configuration/AppConfiguration.h>
 #include <frp/configuration/Ini.h>
 #include <frp/ssl/SSL.h>
+#include <frp/io/File.h>
 #include <frp/net/IPEndPoint.h>
 #include <frp/threading/Hosting.h>
 #include <frp/cryptography/Encryptor.h>
+#include <frp/cryptography/AeadEncryptor.h>
 
 namespace frp {
     namespace configuration {
@@ -18,6 +20,10 @@ namespace frp {
             if (evp_passwd.empty()) {
                 return false;
             }
+
+            if (config.Protocols.Encryptor.Aead) {
+                return frp::cryptography::AeadEncryptor::Support(evp_method);
+            }
             return frp::cryptography::Encryptor::Support(evp_method);
         }
 
@@ -31,6 +37,7 @@ namespace frp {
             const std::string& ssl_certificate_chain_file = config.Protocols.Ssl.CertificateChainFile;
             const std::string& ssl_certificate_key_password = config.Protocols.Ssl.CertificateKeyPassword;
             const std::string& ssl_ciphersuites = config.Protocols.Ssl.Ciphersuites;
+            const std::string& ssl_session_ticket_key_file = config.Protocols.Ssl.SessionTicketKeyFile;
 
             if (hostVerify && ssl_host.empty()) {
                 return false;
@@ -47,6 +54,11 @@ namespace frp {
                     ssl_certificate_chain_file)) {
                     return false;
                 }
+
+                if (ssl_session_ticket_key_file.size() && 
+                    !frp::io::File::CanAccess(ssl_session_ticket_key_file.data(), frp::io::FileAccess::Read)) {
+                    return false;
+                }
             }
             return true;
         }
@@ -74,6 +86,8 @@ namespace frp {
 
             evp_method = section["protocol.encryptor.method"];
             evp_passwd = section["protocol.encryptor.password"];
+            configuration->Protocols.Encryptor.Aead = section.GetValue<bool>("protocol.encryptor.aead");
+            configuration->Protocols.Encryptor.Pipeline = section.GetValue<bool>("protocol.encryptor.pipeline");
 
             if (evp_method.empty()) {
                 return false;
@@ -95,6 +109,9 @@ namespace frp {
             std::string& ssl_certificate_chain_file = configuration->Protocols.Ssl.CertificateChainFile;
             std::string& ssl_certificate_key_password = configuration->Protocols.Ssl.CertificateKeyPassword;
             std::string& ssl_ciphersuites = configuration->Protocols.Ssl.Ciphersuites;
+            std::string& ssl_session_ticket_key_file = configuration->Protocols.Ssl.SessionTicketKeyFile;
+            bool& ssl_early_data = configuration->Protocols.Ssl.EarlyData;
+            bool& ssl_ktls = configuration->Protocols.Ssl.Ktls;
 
             if (configuration->Protocol == ProtocolType::ProtocolType_SSL ||
                 configuration->Protocol == ProtocolType::ProtocolType_WebSocket_SSL) {
@@ -105,6 +122,9 @@ namespace frp {
                 ssl_certificate_chain_file = section["protocol.ssl.certificate-chain-file"];
                 ssl_certificate_key_password = section["protocol.ssl.certificate-key-password"];
                 ssl_ciphersuites = section["protocol.ssl.ciphersuites"];
+                ssl_session_ticket_key_file = section["protocol.ssl.session-ticket-key-file"];
+                ssl_early_data = section.GetValue<bool>("protocol.ssl.early-data");
+                ssl_ktls = section.GetValue<bool>("protocol.ssl.ktls");
             }
             else {
                 ssl_verify_peer = section.GetValue<bool>("protocol.tls.verify-peer");
@@ -114,6 +134,9 @@ namespace frp {
                 ssl_certificate_chain_file = section["protocol.tls.certificate-chain-file"];
                 ssl_certificate_key_password = section["protocol.tls.certificate-key-password"];
                 ssl_ciphersuites = section["protocol.tls.ciphersuites"];
+                ssl_session_ticket_key_file = section["protocol.tls.session-ticket-key-file"];
+                ssl_early_data = section.GetValue<bool>("protocol.tls.early-data");
+                ssl_ktls = section.GetValue<bool>("protocol.tls.ktls");
             }
 
             if (ssl_ciphersuites.empty()) {
@@ -143,6 +166,27 @@ namespace frp {
                 return false;
             }
 
+            /* permessage-deflate, offered by frpc and accepted by frps only when both have it on. */
+            WebSocketCompressionConfiguration& websocket_compression = configuration->Protocols.WebSocket.Compression;
+            websocket_compression.Enabled = section.GetValue<bool>("protocol.websocket.compression");
+            websocket_compression.WindowBits = section.GetValue<int>("protocol.websocket.compression.window-bits");
+            websocket_compression.MemLevel = section.GetValue<int>("protocol.websocket.compression.mem-level");
+            websocket_compression.NoContextTakeover = section.GetValue<bool>("protocol.websocket.compression.no-context-takeover");
+            websocket_compression.Threshold = section.GetValue<int>("protocol.websocket.compression.threshold");
+
+            /* zlib rejects a window of 8 bits in raw deflate mode. */
+            if (websocket_compression.WindowBits < 9 || websocket_compression.WindowBits > 15) {
+                websocket_compression.WindowBits = 15;
+            }
+
+            if (websocket_compression.MemLevel < 1 || websocket_compression.MemLevel > 9) {
+                websocket_compression.MemLevel = 8;
+            }
+
+            if (websocket_compression.Threshold < 1) {
+                websocket_compression.Threshold = 256;
+            }
+
             AppConfiguration_LoadSslConfiguration(configuration, section);
             if (AppConfiguration_VeritySslConfiguration(*configuration, false)) {
                 configuration->Protocols.Ssl.Host.clear();
@@ -154,6 +198,90 @@ namespace frp {
             return true;
         }
 
+        static bool AppConfiguration_LoadReliableUdpConfiguration(std::shared_ptr<AppConfiguration>& configuration, Ini::Section& section) noexcept {
+            ReliableUdpConfiguration& rudp = configuration->Protocols.ReliableUdp;
+            ReliableUdpConfiguration defaults;
+
+            /* Every key is optional, what is missing or out of range keeps its default. */
+            rudp.Mtu = section.GetValue<int>("protocol.rudp.mtu");
+            rudp.SendWindow = section.GetValue<int>("protocol.rudp.send-window");
+            rudp.ReceiveWindow = section.GetValue<int>("protocol.rudp.receive-window");
+            rudp.Interval = section.GetValue<int>("protocol.rudp.interval");
+            rudp.FastResend = section.GetValue<int>("protocol.rudp.fast-resend");
+            rudp.MinRto = section.GetValue<int>("protocol.rudp.min-rto");
+            rudp.Timeout = section.GetValue<int>("protocol.rudp.timeout");
+            rudp.Loss = section.GetValue<int>("protocol.rudp.loss");
+
+            if (section.ContainsKey("protocol.rudp.congestion")) {
+                rudp.Congestion = section.GetValue<bool>("protocol.rudp.congestion");
+            }
+
+            if (section.ContainsKey("protocol.rudp.pacing")) {
+                rudp.Pacing = section.GetValue<bool>("protocol.rudp.pacing");
+            }
+
+            if (rudp.Mtu < 576 || rudp.Mtu > 65507) {
+                rudp.Mtu = defaults.Mtu;
+            }
+
+            if (rudp.SendWindow < 16 || rudp.SendWindow > UINT16_MAX) {
+                rudp.SendWindow = defaults.SendWindow;
+            }
+
+            if (rudp.ReceiveWindow < 256 || rudp.ReceiveWindow > UINT16_MAX) {
+                rudp.ReceiveWindow = defaults.ReceiveWindow;
+            }
+
+            if (rudp.Interval < 1 || rudp.Interval > 100) {
+                rudp.Interval = defaults.Interval;
+            }
+
+            if (rudp.FastResend < 0) {
+                rudp.FastResend = defaults.FastResend;
+            }
+
+            if (rudp.MinRto < 1) {
+                rudp.MinRto = defaults.MinRto;
+            }
+
+            if (rudp.Timeout < 1) {
+                rudp.Timeout = defaults.Timeout;
+            }
+
+            if (rudp.Loss < 0 || rudp.Loss > 100) {
+                rudp.Loss = defaults.Loss;
+            }
+            return true;
+        }
+
+        static bool AppConfiguration_LoadForwardErrorCorrectionConfiguration(std::shared_ptr<AppConfiguration>& configuration, Ini::Section& section) noexcept {
+            ForwardErrorCorrectionConfiguration& fec = configuration->Protocols.Fec;
+            ForwardErrorCorrectionConfiguration defaults;
+
+            fec.Data = section.GetValue<int>("protocol.fec.data");
+            fec.Parity = section.GetValue<int>("protocol.fec.parity");
+            fec.Timeout = section.GetValue<int>("protocol.fec.timeout");
+            fec.Loss = section.GetValue<int>("protocol.fec.loss");
+
+            /* Either end only restores what the other sent with parity, so leaving it off here keeps the decoding. */
+            if (fec.Data < 0 || fec.Data > 128) {
+                fec.Data = defaults.Data;
+            }
+
+            if (fec.Parity < 1 || fec.Parity > 32) {
+                fec.Parity = defaults.Parity;
+            }
+
+            if (fec.Timeout < 1 || fec.Timeout > 1000) {
+                fec.Timeout = defaults.Timeout;
+            }
+
+            if (fec.Loss < 0 || fec.Loss > 100) {
+                fec.Loss = defaults.Loss;
+            }
+            return true;
+        }
+
         std::shared_ptr<AppConfiguration> AppConfiguration::LoadIniFile(const std::string& iniFile) noexcept {
             typedef frp::configuration::Ini Ini;
             typedef frp::net::IPEndPoint    IPEndPoint;
@@ -179,9 +307,23 @@ namespace frp {
                 configuration->Port = section.GetValue<int>("port");
                 configuration->FastOpen = section.GetValue<bool>("fast-open");
                 configuration->Turbo = section.GetValue<bool>("turbo");
+                configuration->Workers = section.GetValue<int>("workers");
                 configuration->Connect.Timeout = section.GetValue<int>("connect.timeout");
                 configuration->Inactive.Timeout = section.GetValue<int>("inactive.timeout");
                 configuration->Handshake.Timeout = section.GetValue<int>("handshake.timeout");
+                configuration->Udp.Gso = section.GetValue<bool>("udp.gso");
+                if (section.ContainsKey("udp.batch")) {
+                    configuration->Udp.Batch = section.GetValue<int>("udp.batch");
+                }
+                if (section.ContainsKey("udp.sessions")) {
+                    configuration->Udp.Sessions = section.GetValue<int>("udp.sessions");
+                }
+                if (section.ContainsKey("udp.timeout")) {
+                    configuration->Udp.Timeout = section.GetValue<int>("udp.timeout");
+                }
+                if (section.ContainsKey("udp.queue")) {
+                    configuration->Udp.Queue = section.GetValue<int>("udp.queue");
+                }
 
                 IPEndPoint ip(configuration->IP.data(), configuration->Port);
                 if (IPEndPoint::IsInvalid(ip)) {
@@ -206,6 +348,46 @@ namespace frp {
                     handshakeTimeout = 5;
                 }
 
+                int& udpBatch = configuration->Udp.Batch;
+                if (udpBatch < 1) {
+                    udpBatch = 1;
+                }
+                elif(udpBatch > 64) {
+                    udpBatch = 64;
+                }
+
+                int& udpSessions = configuration->Udp.Sessions;
+                if (udpSessions < 1) {
+                    udpSessions = 1024;
+                }
+                elif(udpSessions > UINT16_MAX) {
+                    udpSessions = UINT16_MAX;
+                }
+
+                int& udpQueue = configuration->Udp.Queue;
+                if (udpQueue < 1) {
+                    udpQueue = 1024;
+                }
+                elif(udpQueue > UINT16_MAX) {
+                    udpQueue = UINT16_MAX;
+                }
+
+                int& udpTimeout = configuration->Udp.Timeout;
+                if (udpTimeout < 1) {
+                    udpTimeout = 3;
+                }
+                elif(udpTimeout > inactiveTimeout) {
+                    udpTimeout = inactiveTimeout;
+                }
+
+                int& workers = configuration->Workers;
+                if (workers < 0) {
+                    workers = 0;
+                }
+                elif(workers > frp::threading::Hosting::GetMaxConcurrency()) {
+                    workers = frp::threading::Hosting::GetMaxConcurrency();
+                }
+
                 int& alignment = configuration->Alignment;
                 if (alignment < (UINT8_MAX << 1)) {
                     alignment = (UINT8_MAX << 1);
@@ -230,6 +412,9 @@ namespace frp {
                     }
                 }
 
+                configuration->Protocols.Compression = section.GetValue<bool>("protocol.compression");
+                configuration->Protocols.Datagram = section.GetValue<bool>("protocol.datagram");
+
                 std::string protocol = section["protocol"];
                 std::size_t protocol_size = protocol.size();
                 if (protocol_size) {
@@ -256,6 +441,9 @@ namespace frp {
                             configuration->Protocol = ProtocolType::ProtocolType_WebSocket;
                         }
                     }
+                    elif(pch[0] == 'r') { // reliable UDP
+                        configuration->Protocol = ProtocolType::ProtocolType_ReliableUdp;
+                    }
                     elif(pch[0] == 'e') { // EVP
                         configuration->Protocol = ProtocolType::ProtocolType_Encryptor;
                     }
@@ -297,6 +485,20 @@ namespace frp {
                     }
                 }
 
+                /* Loading protocol reliable udp settings. */
+                if (configuration->Protocol == ProtocolType::ProtocolType_ReliableUdp) {
+                    if (!AppConfiguration_LoadReliableUdpConfiguration(configuration, section)) {
+                        return NULL;
+                    }
+                }
+
+                /* Loading datagram channel fec settings. */
+                if (configuration->Protocols.Datagram) {
+                    if (!AppConfiguration_LoadForwardErrorCorrectionConfiguration(configuration, section)) {
+                        return NULL;
+                    }
+                }
+
                 /* Remove app sections. */
                 ini.Remove(section.Name);
             }
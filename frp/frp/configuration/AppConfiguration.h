@@ -3,6 +3,8 @@
 #include <frp/configuration/SslConfiguration.h>
 #include <frp/configuration/MappingConfiguration.h>
 #include <frp/configuration/WebSocketConfiguration.h>
+#include <frp/configuration/ReliableUdpConfiguration.h>
+#include <frp/configuration/ForwardErrorCorrectionConfiguration.h>
 
 namespace frp {
     namespace configuration {
@@ -21,6 +23,7 @@ namespace frp {
             int                                         Backlog = 511;
             bool                                        FastOpen = false;
             bool                                        Turbo = false;
+            int                                         Workers = 0;
             struct {
                 int                                     Timeout = 10;
             }                                           Connect;
@@ -30,6 +33,13 @@ namespace frp {
             struct {
                 int                                     Timeout = 72;
             }                                           Inactive;
+            struct {
+                int                                     Batch = 32;
+                bool                                    Gso = false;
+                int                                     Sessions = 1024;
+                int                                     Queue = 1024;
+                int                                     Timeout = 3;
+            }                                           Udp;
             enum ProtocolType {
                 ProtocolType_None,
                 ProtocolType_TCP = LoopbackMode_None,
@@ -39,16 +49,23 @@ namespace frp {
                 ProtocolType_WebSocket,
                 ProtocolType_WebSocket_SSL,
                 ProtocolType_WebSocket_TLS,
+                ProtocolType_ReliableUdp,
                 ProtocolType_MaxType,
             };
             ProtocolType                                Protocol = ProtocolType::ProtocolType_TCP;
             struct {
                 WebSocketConfiguration                  WebSocket;
                 SslConfiguration                        Ssl;
+                ReliableUdpConfiguration                ReliableUdp;
+                ForwardErrorCorrectionConfiguration     Fec;
                 struct {
                     std::string                         Method;
                     std::string                         Password;
+                    bool                                Aead = false;
+                    bool                                Pipeline = false;
                 }                                       Encryptor;
+                bool                                    Compression = false;
+                bool                                    Datagram = false;
             }                                           Protocols;
             MappingConfigurationArrayList               Mappings;
 
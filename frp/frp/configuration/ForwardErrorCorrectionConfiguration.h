@@ -0,0 +1,14 @@
+#pragma once
+
+#include <frp/stdafx.h>
+
+namespace frp {
+    namespace configuration {
+        struct ForwardErrorCorrectionConfiguration {
+            int                                 Data = 0; /* Datagrams per group, 0 sends no parity at all. */
+            int                                 Parity = 1;
+            int                                 Timeout = 10; /* Milliseconds a group waits to fill up before its parity goes out anyway. */
+            int                                 Loss = 0; /* Percent of the outgoing datagrams dropped on purpose, to try the link out over loopback. */
+        };
+    }
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <frp/stdafx.h>
+
+namespace frp {
+    namespace configuration {
+        struct ReliableUdpConfiguration {
+            int                                 Mtu = 1350;
+            int                                 SendWindow = 256;
+            int                                 ReceiveWindow = 256;
+            int                                 Interval = 10;
+            int                                 FastResend = 2;
+            int                                 MinRto = 30;
+            bool                                Congestion = true;
+            bool                                Pacing = true;
+            int                                 Timeout = 60;
+            int                                 Loss = 0; /* Percent of the outgoing datagrams dropped on purpose, to try the link out over loopback. */
+        };
+    }
+}
\ No newline at end of file
@@ -10,6 +10,9 @@ namespace frp {
             CertificateChainFile.clear();
             CertificateKeyPassword.clear();
             Ciphersuites.clear();
+            SessionTicketKeyFile.clear();
+            EarlyData = false;
+            Ktls = false;
         }
     }
 }
\ No newline at end of file
@@ -13,6 +13,9 @@ namespace frp {
             std::string                         CertificateChainFile;
             std::string                         CertificateKeyPassword;
             std::string                         Ciphersuites;
+            std::string                         SessionTicketKeyFile;
+            bool                                EarlyData = false;
+            bool                                Ktls = false;
 
         public:
             void                                ReleaseAllPairs() noexcept;
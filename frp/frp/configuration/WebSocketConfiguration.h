@@ -4,9 +4,18 @@
 
 namespace frp {
     namespace configuration {
+        struct WebSocketCompressionConfiguration {
+            bool                                Enabled = false;
+            int                                 WindowBits = 15;
+            int                                 MemLevel = 8;
+            bool                                NoContextTakeover = false;
+            int                                 Threshold = 256;
+        };
+
         struct WebSocketConfiguration {
             std::string                         Host;
             std::string                         Path;
+            WebSocketCompressionConfiguration   Compression;
         };
     }
 }
\ No newline at end of file
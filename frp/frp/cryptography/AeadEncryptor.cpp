@@ -0,0 +1,187 @@
+#include <frp/cryptography/AeadEncryptor.h>
+
+namespace frp {
+    namespace cryptography {
+        /* Each direction owns its own nonce space, the initiator (frp client) seals with the first salt. */
+        static const UInt32 AEADENCRYPTOR_INITIATOR_SALT = 0x43534e44;
+        static const UInt32 AEADENCRYPTOR_RESPONDER_SALT = 0x53434e44;
+
+        AeadEncryptor::AeadEncryptor(const std::string& method, const std::string& password) noexcept
+            : _cipher(NULL)
+            , _encryptSalt(AEADENCRYPTOR_INITIATOR_SALT)
+            , _decryptSalt(AEADENCRYPTOR_RESPONDER_SALT)
+            , _encryptCounter(0)
+            , _decryptCounter(0) {
+            initKey(method, password);
+            initCipher(_encryptCTX, 1, 1);
+            initCipher(_decryptCTX, 0, 1);
+        }
+
+        void AeadEncryptor::initKey(const std::string& method, const std::string password) {
+            _cipher = EVP_get_cipherbyname(method.data());
+            if (NULL == _cipher || !Support(method)) {
+                throw std::runtime_error("Such aead encryption cipher methods are not supported");
+            }
+
+            _key = make_shared_alloc<Byte>(EVP_CIPHER_key_length(_cipher));
+            if (NULL == _key) {
+                throw std::runtime_error("Unable to alloc key block memory.");
+            }
+
+            if (EVP_BytesToKey(_cipher, EVP_md5(), NULL, (Byte*)password.data(), (int)password.length(), 1, _key.get(), _iv) < 1) {
+                throw std::runtime_error("Bytes to key calculations cannot be performed using cipher with md5(md) key password iv key etc");
+            }
+        }
+
+        bool AeadEncryptor::initCipher(std::shared_ptr<EVP_CIPHER_CTX>& context, int enc, int raise) {
+            bool exception = false;
+            do {
+                if (NULL == context.get()) {
+                    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+                    context = std::shared_ptr<EVP_CIPHER_CTX>(ctx,
+                        [](EVP_CIPHER_CTX* context) noexcept {
+                            EVP_CIPHER_CTX_cleanup(context);
+                            EVP_CIPHER_CTX_free(context);
+                        });
+                    if ((exception = EVP_CipherInit_ex(context.get(), _cipher, NULL, NULL, NULL, enc) < 1)) {
+                        break;
+                    }
+                    if ((exception = EVP_CIPHER_CTX_ctrl(context.get(), EVP_CTRL_AEAD_SET_IVLEN, NONCE_SIZE, NULL) < 1)) {
+                        break;
+                    }
+
+                    /* The key schedule is expanded once, every frame afterwards only installs a fresh nonce. */
+                    if ((exception = EVP_CipherInit_ex(context.get(), NULL, NULL, _key.get(), NULL, enc) < 1)) {
+                        break;
+                    }
+                }
+            } while (0);
+            if (exception) {
+                if (raise) {
+                    context = NULL;
+                    throw std::runtime_error("There was a problem initializing the cipher that caused an exception to be thrown");
+                }
+                return false;
+            }
+            return true;
+        }
+
+        void AeadEncryptor::SetInitiator(bool initiator) noexcept {
+            if (initiator) {
+                _encryptSalt = AEADENCRYPTOR_INITIATOR_SALT;
+                _decryptSalt = AEADENCRYPTOR_RESPONDER_SALT;
+            }
+            else {
+                _encryptSalt = AEADENCRYPTOR_RESPONDER_SALT;
+                _decryptSalt = AEADENCRYPTOR_INITIATOR_SALT;
+            }
+            _encryptCounter = 0;
+            _decryptCounter = 0;
+        }
+
+        void AeadEncryptor::makeNonce(Byte* nonce, UInt32 salt, UInt64 sequence) noexcept {
+            memcpy(nonce, _iv, NONCE_SIZE);
+            for (int i = 3; i >= 0; i--) {
+                nonce[i] ^= (Byte)(salt);
+                salt >>= 8;
+            }
+
+            for (int i = NONCE_SIZE - 1; i >= NONCE_SIZE - 8; i--) {
+                nonce[i] ^= (Byte)(sequence);
+                sequence >>= 8;
+            }
+        }
+
+        bool AeadEncryptor::Encrypt(Byte* data, int datalen, Byte* tag) noexcept {
+            UInt64 sequence = _encryptCounter++;
+            if (_encryptCounter == 0) { /* Never reuse a nonce under the same key. */
+                return false;
+            }
+            return Encrypt(sequence, data, datalen, tag);
+        }
+
+        bool AeadEncryptor::Decrypt(Byte* data, int datalen, const Byte* tag) noexcept {
+            UInt64 sequence = _decryptCounter++;
+            if (_decryptCounter == 0) {
+                return false;
+            }
+            return Decrypt(sequence, data, datalen, tag);
+        }
+
+        bool AeadEncryptor::Encrypt(UInt64 sequence, Byte* data, int datalen, Byte* tag) noexcept {
+            if (NULL == data || NULL == tag || datalen < 1) {
+                return false;
+            }
+
+            Byte nonce[NONCE_SIZE];
+            makeNonce(nonce, _encryptSalt, sequence);
+
+            EVP_CIPHER_CTX* context = _encryptCTX.get();
+            if (EVP_CipherInit_ex(context, NULL, NULL, NULL, nonce, 1) < 1) {
+                return false;
+            }
+
+            /* Seal the payload in place, the authentication tag is emitted separately. */
+            int outlen = 0;
+            if (EVP_CipherUpdate(context, data, &outlen, data, datalen) < 1) {
+                return false;
+            }
+
+            int finallen = 0;
+            if (EVP_CipherFinal_ex(context, data + outlen, &finallen) < 1) {
+                return false;
+            }
+
+            return EVP_CIPHER_CTX_ctrl(context, EVP_CTRL_AEAD_GET_TAG, TAG_SIZE, tag) > 0;
+        }
+
+        bool AeadEncryptor::Decrypt(UInt64 sequence, Byte* data, int datalen, const Byte* tag) noexcept {
+            if (NULL == data || NULL == tag || datalen < 1) {
+                return false;
+            }
+
+            Byte nonce[NONCE_SIZE];
+            makeNonce(nonce, _decryptSalt, sequence);
+
+            EVP_CIPHER_CTX* context = _decryptCTX.get();
+            if (EVP_CipherInit_ex(context, NULL, NULL, NULL, nonce, 0) < 1) {
+                return false;
+            }
+
+            int outlen = 0;
+            if (EVP_CipherUpdate(context, data, &outlen, data, datalen) < 1) {
+                return false;
+            }
+
+            if (EVP_CIPHER_CTX_ctrl(context, EVP_CTRL_AEAD_SET_TAG, TAG_SIZE, (void*)tag) < 1) {
+                return false;
+            }
+
+            /* A forged or reordered frame fails verification here. */
+            int finallen = 0;
+            return EVP_CipherFinal_ex(context, data + outlen, &finallen) > 0;
+        }
+
+        bool AeadEncryptor::Support(const std::string& method) noexcept {
+            if (method.empty()) {
+                return false;
+            }
+
+            const EVP_CIPHER* cipher = EVP_get_cipherbyname(method.data());
+            if (NULL == cipher) {
+                return false;
+            }
+
+            if ((EVP_CIPHER_flags(cipher) & EVP_CIPH_FLAG_AEAD_CIPHER) == 0) {
+                return false;
+            }
+
+            /* Only ciphers with a 96-bit nonce and stream semantics (GCM, ChaCha20-Poly1305) can seal in place. */
+            const int mode = EVP_CIPHER_mode(cipher);
+            if (mode != EVP_CIPH_GCM_MODE && mode != EVP_CIPH_STREAM_CIPHER) {
+                return false;
+            }
+            return EVP_CIPHER_iv_length(cipher) == NONCE_SIZE;
+        }
+    }
+}
\ No newline at end of file
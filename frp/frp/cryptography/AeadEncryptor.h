@@ -0,0 +1,40 @@
+#pragma once
+
+#include <frp/stdafx.h>
+
+namespace frp {
+    namespace cryptography {
+        class AeadEncryptor final {
+        public:
+            static const int                                    TAG_SIZE   = 16;
+            static const int                                    NONCE_SIZE = 12;
+
+        public:
+            AeadEncryptor(const std::string& method, const std::string& password) noexcept;
+
+        public:
+            static bool                                         Support(const std::string& method) noexcept;
+            void                                                SetInitiator(bool initiator) noexcept;
+            bool                                                Encrypt(Byte* data, int datalen, Byte* tag) noexcept;
+            bool                                                Decrypt(Byte* data, int datalen, const Byte* tag) noexcept;
+            bool                                                Encrypt(UInt64 sequence, Byte* data, int datalen, Byte* tag) noexcept;
+            bool                                                Decrypt(UInt64 sequence, Byte* data, int datalen, const Byte* tag) noexcept;
+
+        private:
+            bool                                                initCipher(std::shared_ptr<EVP_CIPHER_CTX>& context, int enc, int raise);
+            void                                                initKey(const std::string& method, const std::string password);
+            void                                                makeNonce(Byte* nonce, UInt32 salt, UInt64 sequence) noexcept;
+
+        private:
+            const EVP_CIPHER*                                   _cipher;
+            std::shared_ptr<Byte>                               _key; // _cipher->key_len
+            Byte                                                _iv[NONCE_SIZE];
+            UInt32                                              _encryptSalt;
+            UInt32                                              _decryptSalt;
+            UInt64                                              _encryptCounter;
+            UInt64                                              _decryptCounter;
+            std::shared_ptr<EVP_CIPHER_CTX>                     _encryptCTX;
+            std::shared_ptr<EVP_CIPHER_CTX>                     _decryptCTX;
+        };
+    }
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <frp/io/File.h>
 #include <frp/io/MemoryStream.h>
 #include <frp/text/Encoding.h>
+#include <sys/stat.h>
 
 namespace frp {
     namespace io {
@@ -21,6 +22,19 @@ namespace frp {
             return length;
         }
 
+        Int64 File::GetLastWriteTime(const char* path) noexcept {
+            if (NULL == path) {
+                return ~0;
+            }
+
+            struct stat st;
+            if (stat(path, &st) != 0) {
+                return ~0;
+            }
+
+            return (Int64)st.st_mtime;
+        }
+
         bool File::Exists(const char* path) noexcept {
             if (NULL == path) {
                 return false;
@@ -14,6 +14,7 @@ namespace frp {
         public:
             static bool                         CanAccess(const char* path, FileAccess access_) noexcept;
             static int                          GetLength(const char* path) noexcept;
+            static Int64                        GetLastWriteTime(const char* path) noexcept;
             static bool                         Exists(const char* path) noexcept;
             static int                          GetEncoding(const void* p, int length, int& offset) noexcept;
             static std::shared_ptr<Byte>        ReadAllBytes(const char* path, int& length) noexcept;
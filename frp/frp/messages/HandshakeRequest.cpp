@@ -5,7 +5,7 @@
 namespace frp {
     namespace messages {
         std::shared_ptr<Byte> HandshakeRequest::Serialize(int& length) noexcept {
-            frp::io::MemoryStream stream;
+            frp::io::MemoryStream stream(6 + std::min<int>(Name.size(), UINT16_MAX));
             if (!Serialize(stream)) {
                 return NULL;
             }
@@ -28,7 +28,8 @@ namespace frp {
                 stream.WriteByte((Byte)(RemotePort)) &&
                 stream.WriteByte((Byte)(length >> 8)) &&
                 stream.WriteByte((Byte)(length)) &&
-                stream.Write(Name.data(), 0, length);
+                stream.Write(Name.data(), 0, length) &&
+                stream.WriteByte(Features); /* Trails the request, older servers never read that far. */
         }
 
         std::shared_ptr<HandshakeRequest> HandshakeRequest::Deserialize(const void* message, int length) noexcept {
@@ -93,16 +94,23 @@ namespace frp {
                 return NULL;
             }
 
-            if (length == 0) {
-                return request;
+            if (length > 0) {
+                p = reader.ReadBytes(length);
+                if (!p) {
+                    return NULL;
+                }
+                else {
+                    request->Name = std::string((char*)p.get(), length);
+                }
             }
 
-            p = reader.ReadBytes(length);
-            if (!p) {
-                return NULL;
-            }
-            else {
-                request->Name = std::string((char*)p.get(), length);
+            /* Older clients end the request right after the name. */
+            frp::io::Stream& stream = reader.GetStream();
+            if (stream.GetPosition() < stream.GetLength()) {
+                p = reader.ReadBytes(1);
+                if (p) {
+                    request->Features = *p;
+                }
             }
             return request;
         }
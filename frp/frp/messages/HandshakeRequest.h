@@ -11,9 +11,16 @@ namespace frp {
     namespace messages {
         class HandshakeRequest final {
         public:
+            enum {
+                HandshakeFeatures_None                  = 0,
+                HandshakeFeatures_Compression           = 1,
+                HandshakeFeatures_Datagram              = 2,
+                HandshakeFeatures_WriteToBatch          = 4,
+            };
             frp::configuration::MappingType             Type;
             std::string                                 Name;
             int                                         RemotePort;
+            Byte                                        Features = HandshakeFeatures_None;
 
         public:
             std::shared_ptr<Byte>                       Serialize(int& length) noexcept;
@@ -5,17 +5,65 @@
 
 namespace frp {
     namespace messages {
+        int Packet::GetSerializedSize() noexcept {
+            if (Offset < 0 || Length < 0) {
+                return -1;
+            }
+
+            if (Command != frp::messages::PacketCommands::PacketCommands_WriteTo) {
+                return 5 + Length;
+            }
+            else {
+                return 1 + Length;
+            }
+        }
+
         std::shared_ptr<Byte> Packet::Serialize(int& length) noexcept {
-            frp::io::MemoryStream stream;
-            if (!Serialize(stream)) {
+            length = 0;
+
+            /* Compute the exact frame size first so the message is assembled in a single allocation. */
+            const int packet_size = GetSerializedSize();
+            if (packet_size < 1) {
                 return NULL;
             }
 
-            length = stream.GetPosition();
+            std::shared_ptr<Byte> packet = make_shared_alloc<Byte>(packet_size);
+            if (!packet) {
+                return NULL;
+            }
+
+            length = Serialize(packet.get(), packet_size);
             if (length < 1) {
+                length = 0;
                 return NULL;
             }
-            return stream.GetBuffer();
+            return packet;
+        }
+
+        int Packet::Serialize(void* buffer, int length) noexcept {
+            const int packet_size = GetSerializedSize();
+            if (NULL == buffer || packet_size < 1 || length < packet_size) {
+                return -1;
+            }
+
+            const Byte* payload = Buffer.get();
+            if (NULL == payload && Length > 0) {
+                return -1;
+            }
+
+            Byte* p = (Byte*)buffer;
+            *p++ = (Byte)(Command);
+            if (Command != frp::messages::PacketCommands::PacketCommands_WriteTo) {
+                *p++ = (Byte)(Id >> 24);
+                *p++ = (Byte)(Id >> 16);
+                *p++ = (Byte)(Id >> 8);
+                *p++ = (Byte)(Id);
+            }
+
+            if (Length > 0) {
+                memcpy(p, payload + Offset, Length);
+            }
+            return packet_size;
         }
 
         bool Packet::Serialize(frp::io::Stream& stream) noexcept {
@@ -89,8 +137,68 @@ namespace frp {
             messages.Offset = 0;
             frp::messages::NetworkAddress::ToAddress(messages, addressV4, addressV6, endpoint);
 
-            messages.Serialize(stream);
-            return stream.Write((char*)buffer, 0, length);
+            return messages.Serialize(stream) && stream.Write(buffer, offset, length);
+        }
+
+        int Packet::GetWriteToSize(int length, const boost::asio::ip::udp::endpoint& endpoint) noexcept {
+            if (length < 1) {
+                return -1;
+            }
+
+            boost::asio::ip::address address = endpoint.address();
+            if (address.is_v4()) {
+                return 1 + sizeof(frp::messages::NetworkAddressV4) + length;
+            }
+            elif(address.is_v6()) {
+                return 1 + sizeof(frp::messages::NetworkAddressV6) + length;
+            }
+            else {
+                return -1;
+            }
+        }
+
+        int Packet::PackWriteTo(void* packet, int packet_size, const void* buffer, int offset, int length, const boost::asio::ip::udp::endpoint& endpoint) noexcept {
+            if (NULL == packet || NULL == buffer || offset < 0 || length < 1) {
+                return -1;
+            }
+
+            frp::messages::NetworkAddressV4 addressV4;
+            frp::messages::NetworkAddressV6 addressV6;
+
+            frp::messages::Packet messages;
+            messages.Command = frp::messages::PacketCommands::PacketCommands_WriteTo;
+            messages.Id = 0;
+            messages.Offset = 0;
+            frp::messages::NetworkAddress::ToAddress(messages, addressV4, addressV6, endpoint);
+
+            const int address_size = messages.Serialize(packet, packet_size);
+            if (address_size < 1 || packet_size - address_size < length) {
+                return -1;
+            }
+
+            memcpy((Byte*)packet + address_size, (Byte*)buffer + offset, length);
+            return address_size + length;
+        }
+
+        std::shared_ptr<Byte> Packet::PackWriteTo(const void* buffer, int offset, int length, const boost::asio::ip::udp::endpoint& endpoint, int& packet_size) noexcept {
+            packet_size = GetWriteToSize(length, endpoint);
+            if (packet_size < 1) {
+                packet_size = 0;
+                return NULL;
+            }
+
+            std::shared_ptr<Byte> packet = make_shared_alloc<Byte>(packet_size);
+            if (!packet) {
+                packet_size = 0;
+                return NULL;
+            }
+
+            packet_size = PackWriteTo(packet.get(), packet_size, buffer, offset, length, endpoint);
+            if (packet_size < 1) {
+                packet_size = 0;
+                return NULL;
+            }
+            return packet;
         }
     }
 }
\ No newline at end of file
@@ -21,7 +21,9 @@ namespace frp {
             std::shared_ptr<Byte>           Buffer;
 
         public:
+            int                             GetSerializedSize() noexcept;
             std::shared_ptr<Byte>           Serialize(int& length) noexcept;
+            int                             Serialize(void* buffer, int length) noexcept;
             bool                            Serialize(frp::io::Stream& stream) noexcept;
 
         public:
@@ -59,7 +61,10 @@ namespace frp {
                 packet.Length -= next;
                 return packet.Length > ~0;
             }
+            static int                      GetWriteToSize(int length, const boost::asio::ip::udp::endpoint& endpoint) noexcept;
             static bool                     PackWriteTo(frp::io::Stream& stream, const void* buffer, int offset, int length, const boost::asio::ip::udp::endpoint& endpoint) noexcept;
+            static int                      PackWriteTo(void* packet, int packet_size, const void* buffer, int offset, int length, const boost::asio::ip::udp::endpoint& endpoint) noexcept;
+            static std::shared_ptr<Byte>    PackWriteTo(const void* buffer, int offset, int length, const boost::asio::ip::udp::endpoint& endpoint, int& packet_size) noexcept;
         };
     }
 }
\ No newline at end of file
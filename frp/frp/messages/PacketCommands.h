@@ -9,6 +9,10 @@ namespace frp {
             PacketCommands_Write,
             PacketCommands_WriteTo,
             PacketCommands_Heartbeat,
+            PacketCommands_Deflate,
+            PacketCommands_Datagram,
+            PacketCommands_Fec,
+            PacketCommands_WriteToBatch,
         };
     }
 }
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include <frp/messages/WriteToBatch.h>
+
+namespace frp {
+    namespace messages {
+        static const int WRITETOBATCH_HEADER_SIZE = 5;
+
+        WriteToBatch::WriteToBatch() noexcept
+            : size_(0)
+            , count_(0) {
+
+        }
+
+        bool WriteToBatch::Add(const void* buffer, int length, const boost::asio::ip::udp::endpoint& endpoint) noexcept {
+            int packet_size = Packet::GetWriteToSize(length, endpoint);
+            if (packet_size < 1 || !CanBatch(length)) {
+                return false;
+            }
+
+            if (!buffer_) {
+                buffer_ = make_shared_alloc<Byte>(MAX_SIZE);
+                if (!buffer_) {
+                    return false;
+                }
+                size_ = WRITETOBATCH_HEADER_SIZE;
+            }
+
+            /* The WriteTo packet minus its command byte, the length lands on top of that byte. */
+            if (size_ + 1 + packet_size > MAX_SIZE) {
+                return false;
+            }
+
+            Byte* p = buffer_.get() + size_;
+            packet_size = Packet::PackWriteTo(p + 1, MAX_SIZE - size_ - 1, buffer, 0, length, endpoint);
+            if (packet_size < 1) {
+                return false;
+            }
+
+            int tuple_size = packet_size - 1;
+            p[0] = (Byte)(tuple_size >> 8);
+            p[1] = (Byte)(tuple_size);
+
+            size_ += 2 + tuple_size;
+            count_++;
+            return true;
+        }
+
+        std::shared_ptr<Byte> WriteToBatch::Detach(int& length) noexcept {
+            length = 0;
+            if (count_ < 1 || !buffer_) {
+                return NULL;
+            }
+
+            Packet packet;
+            packet.Command = PacketCommands::PacketCommands_WriteToBatch;
+            packet.Id = count_;
+            packet.Offset = 0;
+            packet.Length = 0;
+            packet.Serialize(buffer_.get(), WRITETOBATCH_HEADER_SIZE);
+
+            std::shared_ptr<Byte> packet_ = std::move(buffer_);
+            length = size_;
+            size_ = 0;
+            count_ = 0;
+            return packet_;
+        }
+    }
+}
\ No newline at end of file
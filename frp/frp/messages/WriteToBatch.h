@@ -0,0 +1,67 @@
+#pragma once
+
+#include <frp/messages/Packet.h>
+
+namespace frp {
+    namespace messages {
+        /* Several small WriteTo datagrams in one frame: a PacketCommands_WriteToBatch packet whose Id is the count, followed by length(2) address datagram
+         * for each, the address being that of the WriteTo packet. Filled during one turn of the event loop and written as one frame, so a DNS sized datagram
+         * no longer pays for a frame, a cipher pass and a write of its own. An empty batch is how frps acknowledges that it understands them.
+         */
+        class WriteToBatch final {
+        public:
+            static const int                                                MAX_DATAGRAM = 1024;
+            static const int                                                MAX_SIZE = 16384;
+
+        public:
+            WriteToBatch() noexcept;
+
+        public:
+            inline int                                                      GetCount() noexcept {
+                return count_;
+            }
+            inline static bool                                              CanBatch(int length) noexcept {
+                return length > 0 && length <= MAX_DATAGRAM;
+            }
+            bool                                                            Add(const void* buffer, int length, const boost::asio::ip::udp::endpoint& endpoint) noexcept;
+            std::shared_ptr<Byte>                                           Detach(int& length) noexcept;
+
+        public:
+            template<class TUnpackHandler>
+            static bool                                                     Unpack(const Packet& packet, TUnpackHandler&& handler) noexcept {
+                Byte* buffer = packet.Buffer.get();
+                if (NULL == buffer || packet.Offset < 0 || packet.Length < 0) {
+                    return false;
+                }
+
+                int offset = packet.Offset;
+                int remain = packet.Length;
+                while (remain >= 2) {
+                    int length = buffer[offset] << 8 | buffer[offset + 1];
+                    offset += 2;
+                    remain -= 2;
+                    if (length < 1 || length > remain) {
+                        return false;
+                    }
+
+                    Packet datagram;
+                    datagram.Command = PacketCommands::PacketCommands_WriteTo;
+                    datagram.Id = 0;
+                    datagram.Offset = offset;
+                    datagram.Length = length;
+                    datagram.Buffer = packet.Buffer;
+                    handler(datagram);
+
+                    offset += length;
+                    remain -= length;
+                }
+                return remain == 0;
+            }
+
+        private:
+            std::shared_ptr<Byte>                                           buffer_;
+            int                                                             size_;
+            int                                                             count_;
+        };
+    }
+}
\ No newline at end of file
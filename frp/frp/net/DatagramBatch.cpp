@@ -0,0 +1,360 @@
+#include <frp/net/DatagramBatch.h>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <errno.h>
+
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#endif
+
+namespace frp {
+    namespace net {
+        static const int DATAGRAMBATCH_SLOT             = 65536;
+        static const int DATAGRAMBATCH_MAX_SEGMENTS     = 64;
+        static const int DATAGRAMBATCH_MAX_GSO          = 65000;
+        static const int DATAGRAMBATCH_MAX_QUEUED       = 4 << 20;
+        static const int DATAGRAMBATCH_MAX_RETAINED     = 2048;
+
+        /* Whatever is received is handed on before the next receive on the same thread, so one arena per thread serves every socket on it. */
+        static Byte* DatagramBatch_GetArena(int slots) noexcept {
+            static thread_local std::shared_ptr<Byte> arena;
+            static thread_local int arena_slots = 0;
+
+            if (slots > arena_slots) {
+                arena = make_shared_alloc<Byte>(slots * DATAGRAMBATCH_SLOT);
+                arena_slots = arena ? slots : 0;
+            }
+            return arena.get();
+        }
+
+        DatagramBatch::DatagramBatch(boost::asio::ip::udp::socket& socket, int batch, bool gso, int queue) noexcept
+            : socket_(socket)
+            , batch_(std::max<int>(1, std::min<int>(MAX_BATCH, batch)))
+            , gso_(gso)
+            , gro_(false)
+            , waiting_(false)
+            , queue_(std::max<int>(1, queue))
+            , head_(0)
+            , count_(0)
+            , bytes_(0)
+            , dropped_(0)
+            , failed_(0) {
+
+        }
+
+        bool DatagramBatch::Open() noexcept {
+            if (!socket_.is_open()) {
+                return false;
+            }
+
+            /* A full send buffer has to come back as EAGAIN rather than park the thread all the transmissions are read on. */
+            boost::system::error_code ec;
+            socket_.non_blocking(true, ec);
+            if (ec) {
+                return false;
+            }
+
+#ifdef __linux__
+            /* Both only exist since Linux 4.18 and 5.0, an older kernel just keeps doing one datagram per send and receive. */
+            int fd = socket_.native_handle();
+            if (gso_) {
+                int zero = 0;
+                gso_ = ::setsockopt(fd, SOL_UDP, UDP_SEGMENT, (char*)&zero, sizeof(zero)) == 0;
+            }
+
+            if (gso_ && IsBatch()) {
+                int one = 1;
+                gro_ = ::setsockopt(fd, SOL_UDP, UDP_GRO, (char*)&one, sizeof(one)) == 0;
+            }
+#else
+            gso_ = false;
+            gro_ = false;
+#endif
+            return true;
+        }
+
+        bool DatagramBatch::ReceiveFrom(const ReceiveFromCallback& callback) noexcept {
+            Byte* arena = DatagramBatch_GetArena(batch_);
+            if (NULL == arena || !socket_.is_open()) {
+                return false;
+            }
+
+#ifdef __linux__
+            struct mmsghdr msgs[MAX_BATCH];
+            struct iovec iovs[MAX_BATCH];
+            struct sockaddr_storage addresses[MAX_BATCH];
+            char controls[MAX_BATCH][CMSG_SPACE(sizeof(int))];
+
+            memset(msgs, 0, sizeof(*msgs) * batch_);
+            for (int i = 0; i < batch_; i++) {
+                iovs[i].iov_base = arena + i * DATAGRAMBATCH_SLOT;
+                iovs[i].iov_len = DATAGRAMBATCH_SLOT;
+
+                struct msghdr& hdr = msgs[i].msg_hdr;
+                hdr.msg_name = &addresses[i];
+                hdr.msg_namelen = sizeof(addresses[i]);
+                hdr.msg_iov = &iovs[i];
+                hdr.msg_iovlen = 1;
+                if (gro_) {
+                    hdr.msg_control = controls[i];
+                    hdr.msg_controllen = sizeof(controls[i]);
+                }
+            }
+
+            int count = ::recvmmsg(socket_.native_handle(), msgs, batch_, MSG_DONTWAIT, NULL);
+            if (count < 0) {
+                return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            }
+
+            boost::asio::ip::udp::endpoint endpoint;
+            for (int i = 0; i < count; i++) {
+                struct msghdr& hdr = msgs[i].msg_hdr;
+                if (hdr.msg_namelen > endpoint.capacity()) {
+                    continue;
+                }
+
+                memcpy(endpoint.data(), hdr.msg_name, hdr.msg_namelen);
+                endpoint.resize(hdr.msg_namelen);
+
+                /* GRO hands over a run of equally sized datagrams from one sender as one buffer, cut back at the segment size. */
+                int segment = 0;
+                if (gro_) {
+                    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); NULL != cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+                        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+                            memcpy(&segment, CMSG_DATA(cmsg), sizeof(segment));
+                            break;
+                        }
+                    }
+                }
+
+                Byte* buffer = (Byte*)iovs[i].iov_base;
+                int length = (int)msgs[i].msg_len;
+                if (segment < 1 || segment >= length) {
+                    segment = length;
+                }
+
+                for (int offset = 0; offset < length; offset += segment) {
+                    if (!callback(buffer + offset, std::min<int>(segment, length - offset), endpoint)) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+#else
+            boost::asio::ip::udp::endpoint endpoint;
+            for (int i = 0; i < batch_; i++) {
+                boost::system::error_code ec;
+                std::size_t available = socket_.available(ec);
+                if (ec) {
+                    return false;
+                }
+
+                if (available == 0 && i > 0) {
+                    break;
+                }
+
+                std::size_t sz = socket_.receive_from(boost::asio::buffer(arena, DATAGRAMBATCH_SLOT), endpoint, 0, ec);
+                if (ec) {
+                    return false;
+                }
+
+                if (!callback(arena, (int)sz, endpoint)) {
+                    return false;
+                }
+            }
+            return true;
+#endif
+        }
+
+        int DatagramBatch::SendTo(const void* buffer, int length, const boost::asio::ip::udp::endpoint& endpoint) noexcept {
+            if (NULL == buffer || length < 1) {
+                return -1;
+            }
+
+            if (count_ >= queue_ || bytes_ + length > DATAGRAMBATCH_MAX_QUEUED) {
+                dropped_++;
+                return 0;
+            }
+
+            /* The ring only grows as far as the traffic needs, an idle socket keeps next to nothing. */
+            int capacity = messages_.size();
+            if (count_ >= capacity) {
+                std::rotate(messages_.begin(), messages_.begin() + head_, messages_.end());
+                messages_.resize(std::min<int>(queue_, std::max<int>(batch_, capacity << 1)));
+                head_ = 0;
+            }
+
+            message& m = At(count_++);
+            m.endpoint = endpoint;
+            m.length = length;
+            m.data.resize(length);
+            memcpy(m.data.data(), buffer, length);
+            bytes_ += length;
+            return count_;
+        }
+
+        void DatagramBatch::Pop(int count) noexcept {
+            if (count < 1) {
+                return;
+            }
+
+            for (int i = 0; i < count; i++) {
+                message& m = At(i);
+                bytes_ -= m.length;
+                if (m.data.capacity() > DATAGRAMBATCH_MAX_RETAINED) {
+                    std::vector<Byte>().swap(m.data);
+                }
+            }
+
+            head_ = (head_ + count) % messages_.size();
+            count_ -= count;
+            if (count_ == 0) {
+                head_ = 0;
+            }
+        }
+
+        bool DatagramBatch::FlushAsync(const std::shared_ptr<Reference>& reference) noexcept {
+            if (waiting_) {
+                return true;
+            }
+
+            bool success = Flush();
+            if (count_ > 0 && socket_.is_open()) {
+                waiting_ = true;
+                socket_.async_wait(boost::asio::ip::udp::socket::wait_write,
+                    [reference, this](const boost::system::error_code& ec) noexcept {
+                        waiting_ = false;
+                        if (ec != boost::system::errc::operation_canceled) {
+                            FlushAsync(reference);
+                        }
+                    });
+            }
+            return success;
+        }
+
+        bool DatagramBatch::Flush() noexcept {
+            if (!socket_.is_open()) {
+                dropped_ += count_;
+                Pop(count_);
+                return false;
+            }
+
+            bool success = true;
+#ifdef __linux__
+            int fd = socket_.native_handle();
+            while (count_ > 0) {
+                struct mmsghdr msgs[MAX_BATCH];
+                struct iovec iovs[MAX_BATCH];
+                int firsts[MAX_BATCH + 1];
+                char controls[MAX_BATCH][CMSG_SPACE(sizeof(uint16_t))];
+
+                int n = 0;
+                int count = std::min<int>(count_, batch_);
+                memset(msgs, 0, sizeof(*msgs) * count);
+                for (int i = 0; i < count;) {
+                    message& m = At(i);
+                    int segments = 1;
+                    if (gso_) {
+                        /* A run to one destination of equally sized datagrams, only the last may be shorter, goes down as one send the kernel segments. */
+                        int total = m.length;
+                        while (i + segments < count && segments < DATAGRAMBATCH_MAX_SEGMENTS) {
+                            message& next = At(i + segments);
+                            if (next.endpoint != m.endpoint || next.length > m.length || total + next.length > DATAGRAMBATCH_MAX_GSO) {
+                                break;
+                            }
+
+                            total += next.length;
+                            segments++;
+                            if (next.length < m.length) {
+                                break;
+                            }
+                        }
+                    }
+
+                    for (int k = 0; k < segments; k++) {
+                        message& segment = At(i + k);
+                        iovs[i + k].iov_base = segment.data.data();
+                        iovs[i + k].iov_len = segment.length;
+                    }
+
+                    struct msghdr& hdr = msgs[n].msg_hdr;
+                    hdr.msg_name = m.endpoint.data();
+                    hdr.msg_namelen = m.endpoint.size();
+                    hdr.msg_iov = &iovs[i];
+                    hdr.msg_iovlen = segments;
+                    if (segments > 1) {
+                        hdr.msg_control = controls[n];
+                        hdr.msg_controllen = sizeof(controls[n]);
+
+                        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+                        cmsg->cmsg_level = SOL_UDP;
+                        cmsg->cmsg_type = UDP_SEGMENT;
+                        cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+
+                        uint16_t segment = (uint16_t)m.length;
+                        memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+                    }
+
+                    firsts[n++] = i;
+                    i += segments;
+                }
+                firsts[n] = count;
+
+                int r = ::sendmmsg(fd, msgs, n, MSG_DONTWAIT);
+                if (r > 0) {
+                    Pop(firsts[r]);
+                    continue;
+                }
+
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                /* The send buffer is full, the rest waits for the socket to turn writable. */
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    break;
+                }
+
+                /* The device refused segmentation offload, GSO stays off from now on and the same datagrams go again one by one. */
+                if (msgs[0].msg_hdr.msg_iovlen > 1 && (errno == EIO || errno == EINVAL)) {
+                    gso_ = false;
+                    continue;
+                }
+
+                /* A destination that cannot be reached only costs its own datagrams. */
+                failed_ += firsts[1];
+                success = false;
+                Pop(firsts[1]);
+            }
+#else
+            while (count_ > 0) {
+                message& m = At(0);
+                boost::system::error_code ec;
+                socket_.send_to(boost::asio::buffer(m.data.data(), m.length), m.endpoint, 0, ec);
+                if (ec == boost::asio::error::would_block || ec == boost::asio::error::try_again) {
+                    break;
+                }
+
+                if (ec) {
+                    failed_++;
+                    success = false;
+                }
+                Pop(1);
+            }
+#endif
+            return success;
+        }
+    }
+}
\ No newline at end of file
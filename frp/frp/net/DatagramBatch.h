@@ -0,0 +1,71 @@
+#pragma once
+
+#include <frp/stdafx.h>
+#include <frp/Reference.h>
+
+namespace frp {
+    namespace net {
+        /* Moves the datagrams of one UDP socket in batches: recvmmsg drains up to Batch datagrams per readiness event, sendmmsg sends whatever
+         * was queued during one turn of the event loop, and with GSO/GRO the kernel splits and coalesces runs of equally sized datagrams to one
+         * destination by itself. The owner drives it, async_wait for readability and a posted FlushAsync after the first SendTo of a turn.
+         * Sending never blocks: what the socket cannot take stays queued until it turns writable, up to Queue datagrams, and whatever
+         * arrives beyond that is dropped and counted, as a full router queue would. Anywhere but Linux it goes one datagram per call.
+         */
+        class DatagramBatch final {
+        public:
+            typedef std::function<bool(Byte*, int, const boost::asio::ip::udp::endpoint&)> ReceiveFromCallback;
+
+        public:
+            static const int                                                MAX_BATCH = 64;
+
+        public:
+            DatagramBatch(boost::asio::ip::udp::socket& socket, int batch, bool gso, int queue) noexcept;
+
+        public:
+            inline bool                                                     IsBatch() noexcept {
+                return batch_ > 1;
+            }
+            inline int                                                      GetCount() noexcept {
+                return count_;
+            }
+            inline UInt64                                                   GetDropped() noexcept {
+                return dropped_;
+            }
+            inline UInt64                                                   GetFailed() noexcept {
+                return failed_;
+            }
+            bool                                                            Open() noexcept;
+            bool                                                            ReceiveFrom(const ReceiveFromCallback& callback) noexcept;
+            int                                                             SendTo(const void* buffer, int length, const boost::asio::ip::udp::endpoint& endpoint) noexcept;
+            bool                                                            Flush() noexcept;
+            bool                                                            FlushAsync(const std::shared_ptr<Reference>& reference) noexcept;
+
+        private:
+            struct message {
+                boost::asio::ip::udp::endpoint                              endpoint;
+                std::vector<Byte>                                           data;
+                int                                                         length;
+            };
+
+        private:
+            inline message&                                                 At(int index) noexcept {
+                return messages_[(head_ + index) % messages_.size()];
+            }
+            void                                                            Pop(int count) noexcept;
+
+        private:
+            boost::asio::ip::udp::socket&                                   socket_;
+            int                                                             batch_;
+            bool                                                            gso_;
+            bool                                                            gro_;
+            bool                                                            waiting_;
+            int                                                             queue_;
+            int                                                             head_;
+            int                                                             count_;
+            int                                                             bytes_;
+            UInt64                                                          dropped_;
+            UInt64                                                          failed_;
+            std::vector<message>                                            messages_;
+        };
+    }
+}
\ No newline at end of file
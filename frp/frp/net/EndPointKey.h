@@ -0,0 +1,66 @@
+#pragma once
+
+#include <frp/stdafx.h>
+#include <boost/asio.hpp>
+
+namespace frp {
+    namespace net {
+        /* An endpoint as a 20 byte value, IPv4 kept v4 mapped, so it can be built, compared and hashed per datagram without formatting or allocating. */
+        struct EndPointKey {
+        public:
+            Byte                                                                Address[16];
+            UInt16                                                              Port;
+            UInt16                                                              Padding;
+
+        public:
+            template<class TProtocol>
+            inline static EndPointKey                                           From(const boost::asio::ip::basic_endpoint<TProtocol>& endpoint) noexcept {
+                EndPointKey key;
+                const boost::asio::ip::address address = endpoint.address();
+                if (address.is_v4()) {
+                    boost::asio::ip::address_v4::bytes_type bytes = address.to_v4().to_bytes();
+                    memset(key.Address, 0, 10);
+                    key.Address[10] = 0xff;
+                    key.Address[11] = 0xff;
+                    memcpy(key.Address + 12, bytes.data(), 4);
+                }
+                else {
+                    boost::asio::ip::address_v6::bytes_type bytes = address.to_v6().to_bytes();
+                    memcpy(key.Address, bytes.data(), 16);
+                }
+
+                key.Port = endpoint.port();
+                key.Padding = 0;
+                return key;
+            }
+            inline bool                                                         operator==(const EndPointKey& other) const noexcept {
+                return memcmp(this, &other, sizeof(EndPointKey)) == 0;
+            }
+            inline bool                                                         operator!=(const EndPointKey& other) const noexcept {
+                return !(*this == other);
+            }
+            inline std::size_t                                                  GetHashCode() const noexcept {
+                UInt64 hi, lo;
+                memcpy(&hi, Address, sizeof(hi));
+                memcpy(&lo, Address + 8, sizeof(lo));
+
+                /* Two multiply-xorshift rounds (the splitmix64 finalizer), every key bit reaches the low bits a power of two table masks. */
+                UInt64 h = hi ^ (lo * 0x9e3779b97f4a7c15ULL) ^ ((UInt64)Port << 48);
+                h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+                return (std::size_t)(h ^ (h >> 31));
+            }
+        };
+        static_assert(sizeof(EndPointKey) == 20, "EndPointKey must stay a packed 20 byte value.");
+    }
+}
+
+namespace std {
+    template<>
+    struct hash<frp::net::EndPointKey> {
+    public:
+        inline std::size_t                                                      operator()(const frp::net::EndPointKey& key) const noexcept {
+            return key.GetHashCode();
+        }
+    };
+}
\ No newline at end of file
@@ -188,6 +188,29 @@ namespace frp {
                 }
                 return h;
             }
+            template<class TProtocol>
+            inline static std::size_t                                           GetHashCode(const boost::asio::ip::basic_endpoint<TProtocol>& endpoint) noexcept {
+                /* FNV-1a over the address bytes and the port, a UDP flow is told apart by nothing else. */
+                UInt64 h = 14695981039346656037ULL;
+                const boost::asio::ip::address address = endpoint.address();
+                if (address.is_v4()) {
+                    boost::asio::ip::address_v4::bytes_type bytes = address.to_v4().to_bytes();
+                    for (std::size_t i = 0; i < bytes.size(); i++) {
+                        h = (h ^ bytes[i]) * 1099511628211ULL;
+                    }
+                }
+                else {
+                    boost::asio::ip::address_v6::bytes_type bytes = address.to_v6().to_bytes();
+                    for (std::size_t i = 0; i < bytes.size(); i++) {
+                        h = (h ^ bytes[i]) * 1099511628211ULL;
+                    }
+                }
+
+                int port = endpoint.port();
+                h = (h ^ (Byte)(port >> 8)) * 1099511628211ULL;
+                h = (h ^ (Byte)(port)) * 1099511628211ULL;
+                return (std::size_t)h;
+            }
             std::string                                                         ToString() noexcept;
 
         public:
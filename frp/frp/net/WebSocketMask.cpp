@@ -0,0 +1,102 @@
+#include <frp/net/WebSocketMask.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#define FRP_WEBSOCKETMASK_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(FRP_WEBSOCKETMASK_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define FRP_WEBSOCKETMASK_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace frp {
+    namespace net {
+        typedef std::size_t(*WebSocketMaskKernel)(Byte* data, std::size_t length, UInt32 key);
+
+        /* Whole 64-bit words, the tail is left to WebSocketMask::Mask. */
+        static std::size_t WebSocketMask_Scalar(Byte* data, std::size_t length, UInt32 key) noexcept {
+            UInt64 k = (UInt64)key << 32 | key;
+            std::size_t i = 0;
+            for (; i + 8 <= length; i += 8) {
+                UInt64 v;
+                memcpy(&v, data + i, 8);
+                v ^= k;
+                memcpy(data + i, &v, 8);
+            }
+            return i;
+        }
+
+#ifdef FRP_WEBSOCKETMASK_SSE2
+        static std::size_t WebSocketMask_SSE2(Byte* data, std::size_t length, UInt32 key) noexcept {
+            const __m128i k = _mm_set1_epi32((int)key);
+            std::size_t i = 0;
+            for (; i + 64 <= length; i += 64) {
+                __m128i v0 = _mm_loadu_si128((const __m128i*)(data + i));
+                __m128i v1 = _mm_loadu_si128((const __m128i*)(data + i + 16));
+                __m128i v2 = _mm_loadu_si128((const __m128i*)(data + i + 32));
+                __m128i v3 = _mm_loadu_si128((const __m128i*)(data + i + 48));
+                _mm_storeu_si128((__m128i*)(data + i), _mm_xor_si128(v0, k));
+                _mm_storeu_si128((__m128i*)(data + i + 16), _mm_xor_si128(v1, k));
+                _mm_storeu_si128((__m128i*)(data + i + 32), _mm_xor_si128(v2, k));
+                _mm_storeu_si128((__m128i*)(data + i + 48), _mm_xor_si128(v3, k));
+            }
+            for (; i + 16 <= length; i += 16) {
+                __m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+                _mm_storeu_si128((__m128i*)(data + i), _mm_xor_si128(v, k));
+            }
+            return i + WebSocketMask_Scalar(data + i, length - i, key);
+        }
+#endif
+
+#ifdef FRP_WEBSOCKETMASK_AVX2
+        __attribute__((target("avx2")))
+        static std::size_t WebSocketMask_AVX2(Byte* data, std::size_t length, UInt32 key) noexcept {
+            const __m256i k = _mm256_set1_epi32((int)key);
+            std::size_t i = 0;
+            for (; i + 128 <= length; i += 128) {
+                __m256i v0 = _mm256_loadu_si256((const __m256i*)(data + i));
+                __m256i v1 = _mm256_loadu_si256((const __m256i*)(data + i + 32));
+                __m256i v2 = _mm256_loadu_si256((const __m256i*)(data + i + 64));
+                __m256i v3 = _mm256_loadu_si256((const __m256i*)(data + i + 96));
+                _mm256_storeu_si256((__m256i*)(data + i), _mm256_xor_si256(v0, k));
+                _mm256_storeu_si256((__m256i*)(data + i + 32), _mm256_xor_si256(v1, k));
+                _mm256_storeu_si256((__m256i*)(data + i + 64), _mm256_xor_si256(v2, k));
+                _mm256_storeu_si256((__m256i*)(data + i + 96), _mm256_xor_si256(v3, k));
+            }
+            for (; i + 32 <= length; i += 32) {
+                __m256i v = _mm256_loadu_si256((const __m256i*)(data + i));
+                _mm256_storeu_si256((__m256i*)(data + i), _mm256_xor_si256(v, k));
+            }
+            return i + WebSocketMask_SSE2(data + i, length - i, key);
+        }
+#endif
+
+        static WebSocketMaskKernel WebSocketMask_Kernel() noexcept {
+#ifdef FRP_WEBSOCKETMASK_AVX2
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) {
+                return WebSocketMask_AVX2;
+            }
+#endif
+#ifdef FRP_WEBSOCKETMASK_SSE2
+            return WebSocketMask_SSE2;
+#else
+            return WebSocketMask_Scalar;
+#endif
+        }
+
+        void WebSocketMask::Mask(Byte* data, std::size_t length, const Byte key[4]) noexcept {
+            static const WebSocketMaskKernel kernel = WebSocketMask_Kernel();
+
+            /* The key laid out as it sits in memory, so each lane lines up with data + 4n. */
+            UInt32 k;
+            memcpy(&k, key, 4);
+
+            std::size_t i = length < 16 ? 0 : kernel(data, length, k);
+            for (; i < length; i++) {
+                data[i] ^= key[i & 3];
+            }
+        }
+    }
+}
\ No newline at end of file
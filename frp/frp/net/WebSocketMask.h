@@ -0,0 +1,44 @@
+#pragma once
+
+#include <frp/stdafx.h>
+
+namespace frp {
+    namespace net {
+        /* The XOR masking of websocket frames (RFC 6455 5.3), every client to server byte goes through it on the frps loop thread.
+         * Vectorized with AVX2 when the CPU has it, SSE2 on any x86-64, 64-bit words elsewhere.
+         */
+        class WebSocketMask final {
+        public:
+            static void                                                     Mask(Byte* data, std::size_t length, const Byte key[4]) noexcept;
+        };
+    }
+}
+
+namespace boost {
+    namespace beast {
+        namespace websocket {
+            namespace detail {
+                /* Stands in for beast's detail/mask.ipp, whose include guard stdafx.h defines before beast is pulled in. */
+                inline void                                                 prepare_key(prepared_key& prepared, std::uint32_t key) {
+                    prepared[0] = (key >> 0) & 0xff;
+                    prepared[1] = (key >> 8) & 0xff;
+                    prepared[2] = (key >> 16) & 0xff;
+                    prepared[3] = (key >> 24) & 0xff;
+                }
+                inline void                                                 mask_inplace(net::mutable_buffer const& b, prepared_key& key) {
+                    std::size_t n = b.size();
+                    frp::net::WebSocketMask::Mask(static_cast<frp::Byte*>(b.data()), n, key.data());
+
+                    /* The next buffer of the frame picks up the key where this one left it. */
+                    std::size_t r = n & 3;
+                    if (r) {
+                        const prepared_key k = key;
+                        for (std::size_t i = 0; i < 4; i++) {
+                            key[i] = k[(i + r) & 3];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -3,13 +3,17 @@
 #include <frp/server/Connection.h>
 #include <frp/net/Socket.h>
 #include <frp/net/IPEndPoint.h>
-#include <frp/io/MemoryStream.h>
 #include <frp/messages/Packet.h>
 #include <frp/messages/NetworkAddress.h>
+#include <frp/messages/WriteToBatch.h>
 #include <frp/transmission/ITransmission.h>
+#include <frp/transmission/DatagramChannel.h>
+#include <frp/collections/Dictionary.h>
 
 namespace frp {
     namespace server {
+        static const UInt64 MAPPINGENTRY_DROPPED_INTERVAL = 5000;
+
         MappingEntry::MappingEntry(Switches& switches, const std::string& name, frp::configuration::MappingType type, int port) noexcept
             : Name(name)
             , Type(type)
@@ -20,7 +24,9 @@ namespace frp {
             , context_(switches.GetContext())
             , buffer_(hosting_->GetBuffer())
             , socket_(*context_)
-            , acceptor_(*context_) {
+            , acceptor_(*context_)
+            , batch_(socket_, switches.GetConfiguration()->Udp.Batch, switches.GetConfiguration()->Udp.Gso, switches.GetConfiguration()->Udp.Queue)
+            , dropped_(0) {
 
         }
 
@@ -28,6 +34,8 @@ namespace frp {
             if (!disposed_.exchange(true)) {
                 ConnectionManager::ReleaseAllConnection();
                 TransmissionManager::ReleaseAllTransmission();
+                frp::collections::Dictionary::ReleaseAllPairs(channels_);
+                batches_.clear();
 
                 frp::net::Socket::Closesocket(acceptor_);
                 frp::net::Socket::Closesocket(socket_);
@@ -91,6 +99,10 @@ namespace frp {
                     return false;
                 }
 
+                if (!batch_.Open()) {
+                    return false;
+                }
+
                 return ForwardedToFrpClientAsync();
             }
             else {
@@ -104,6 +116,10 @@ namespace frp {
                 return false;
             }
 
+            if (batch_.IsBatch()) {
+                return ForwardedToFrpClientBatchAsync();
+            }
+
             std::shared_ptr<Reference> reference = GetReference();
             socket_.async_receive_from(boost::asio::buffer(buffer_.get(), frp::threading::Hosting::BufferSize), endpoint_,
                 [reference, this](const boost::system::error_code& ec, std::size_t sz) noexcept {
@@ -138,19 +154,91 @@ namespace frp {
             return true;
         }
 
+        bool MappingEntry::ForwardedToFrpClientBatchAsync() noexcept {
+            std::shared_ptr<Reference> reference = GetReference();
+            socket_.async_wait(boost::asio::ip::udp::socket::wait_read,
+                [reference, this](const boost::system::error_code& ec) noexcept {
+                    /* Cancellation of the current asynchronous operation means that the dynamic port mapping has been marked free. */
+                    if (ec == boost::system::errc::operation_canceled) {
+                        Close();
+                        return;
+                    }
+
+                    /* Everything already queued on the socket is drained in one go, each datagram still goes to the frp client on its own. */
+                    bool success = !ec && batch_.ReceiveFrom(
+                        [this](Byte* buffer, int length, const boost::asio::ip::udp::endpoint& endpoint) noexcept {
+                            return SendToFrpClientAsync(buffer, length, endpoint);
+                        });
+                    if (success) {
+                        ForwardedToFrpClientAsync();
+                    }
+                });
+            return true;
+        }
+
         bool MappingEntry::SendToFrpClientAsync(const void* buffer, int length, const boost::asio::ip::udp::endpoint& endpoint) noexcept {
-            frp::io::MemoryStream messages;
-            if (!frp::messages::Packet::PackWriteTo(messages, buffer, 0, length, endpoint)) {
+            /* One flow, one transmission, so its datagrams are not reordered across the concurrent transmissions. */
+            const TransmissionPtr transmission = GetTransmission(frp::net::IPEndPoint::GetHashCode(endpoint));
+            if (!transmission) {
                 return false;
             }
 
-            const TransmissionPtr transmission = GetTransmission();
-            if (!transmission) {
+            /* Straight over UDP while frpc answers there, otherwise in band as before. */
+            DatagramChannelPtr channel;
+            if (frp::collections::Dictionary::TryGetValue(channels_, transmission.get(), channel) && channel->WriteTo(buffer, length, endpoint)) {
+                return true;
+            }
+
+            /* Small datagrams share frames once frpc understands batches, a large one first flushes what is queued to keep a flow in order. */
+            WriteToBatchPtr batch;
+            if (frp::collections::Dictionary::TryGetValue(batches_, transmission.get(), batch)) {
+                if (frp::messages::WriteToBatch::CanBatch(length)) {
+                    return WriteToBatchAsync(transmission, batch, buffer, length, endpoint);
+                }
+
+                if (!FlushBatchAsync(transmission, batch)) {
+                    return false;
+                }
+            }
+
+            int packet_size;
+            const std::shared_ptr<Byte> packet = frp::messages::Packet::PackWriteTo(buffer, 0, length, endpoint, packet_size);
+            if (!packet) {
                 return false;
             }
 
-            const int packet_size = messages.GetPosition();
-            const std::shared_ptr<Byte> packet = messages.GetBuffer();
+            const std::shared_ptr<Reference> reference = GetReference();
+            return Then(transmission,
+                transmission->WriteAsync(packet, 0, packet_size,
+                    [reference, this, transmission](bool success) noexcept {
+                        Then(transmission, success);
+                    }));
+        }
+
+        bool MappingEntry::WriteToBatchAsync(const TransmissionPtr& transmission, const WriteToBatchPtr& batch, const void* buffer, int length, const boost::asio::ip::udp::endpoint& endpoint) noexcept {
+            if (!batch->Add(buffer, length, endpoint)) {
+                if (!FlushBatchAsync(transmission, batch) || !batch->Add(buffer, length, endpoint)) {
+                    return false;
+                }
+            }
+
+            /* The first datagram of a batch schedules its flush, whatever else arrives in the same turn of the event loop rides along. */
+            if (batch->GetCount() == 1) {
+                const std::shared_ptr<Reference> reference = GetReference();
+                boost::asio::post(*context_,
+                    [reference, this, transmission, batch]() noexcept {
+                        FlushBatchAsync(transmission, batch);
+                    });
+            }
+            return true;
+        }
+
+        bool MappingEntry::FlushBatchAsync(const TransmissionPtr& transmission, const WriteToBatchPtr& batch) noexcept {
+            int packet_size;
+            const std::shared_ptr<Byte> packet = batch->Detach(packet_size);
+            if (!packet) {
+                return true;
+            }
 
             const std::shared_ptr<Reference> reference = GetReference();
             return Then(transmission,
@@ -183,6 +271,9 @@ namespace frp {
             case frp::messages::PacketCommands_WriteTo:
                 OnHandleWriteTo(transmission, *packet);
                 break;
+            case frp::messages::PacketCommands_WriteToBatch:
+                OnHandleWriteToBatch(transmission, *packet);
+                break;
             case frp::messages::PacketCommands_Heartbeat:
                 OnHandleHeartbeat(transmission);
                 break;
@@ -250,9 +341,33 @@ namespace frp {
                 return false;
             }
 
-            boost::system::error_code ec;
-            socket_.send_to(boost::asio::buffer(packet.Buffer.get() + packet.Offset, packet.Length), destinationEP, 0, ec);
-            return ec ? false : true;
+            /* Queued and sent after the packets at hand, the replies of one turn leave together in one sendmmsg and a full socket only ever costs
+             * the replies that do not fit into the queue anymore, never a stall of the transmission they came over.
+             */
+            int queued = batch_.SendTo(packet.Buffer.get() + packet.Offset, packet.Length, destinationEP);
+            if (queued == 1) {
+                std::shared_ptr<Reference> reference = GetReference();
+                boost::asio::post(*context_,
+                    [reference, this]() noexcept {
+                        batch_.FlushAsync(reference);
+                    });
+            }
+            elif(queued == 0) {
+                UInt64 now = hosting_->CurrentMillisec();
+                if (now - dropped_ >= MAPPINGENTRY_DROPPED_INTERVAL) {
+                    dropped_ = now;
+                    LOG_WARN("Drop udp: name %s, port %d, dropped %llu, failed %llu.", Name.data(), Port,
+                        (unsigned long long)batch_.GetDropped(), (unsigned long long)batch_.GetFailed());
+                }
+            }
+            return queued >= 0;
+        }
+
+        bool MappingEntry::OnHandleWriteToBatch(const TransmissionPtr& transmission, frp::messages::Packet& packet) noexcept {
+            return frp::messages::WriteToBatch::Unpack(packet,
+                [this, &transmission](frp::messages::Packet& datagram) noexcept {
+                    OnHandleWriteTo(transmission, datagram);
+                });
         }
 
         bool MappingEntry::PacketInputAsync(const TransmissionPtr& transmission) noexcept {
@@ -332,6 +447,13 @@ namespace frp {
         }
 
         void MappingEntry::CloseTransmission(const TransmissionPtr& transmission) noexcept {
+            DatagramChannelPtr channel;
+            if (frp::collections::Dictionary::TryRemove(channels_, transmission.get(), channel)) {
+                channel->Close();
+            }
+
+            batches_.erase(transmission.get());
+
             if (TransmissionManager::CloseTransmission(transmission.get())) {
                 const std::shared_ptr<frp::configuration::AppConfiguration>& configuration = switches_.GetConfiguration();
                 if (TransmissionManager::GetTransmissionCount()) {
@@ -348,5 +470,83 @@ namespace frp {
         }
 #undef MAPPINGENTRY_LOGF
 #endif
+
+        bool MappingEntry::AddChannel(const TransmissionPtr& transmission, const DatagramChannelPtr& channel, const std::string& secret) noexcept {
+            if (disposed_ || !transmission || !channel || Type != MappingType::MappingType_UDP) {
+                return false;
+            }
+
+            const TransmissionPtr stransmission = transmission;
+            const std::shared_ptr<Reference> sreference = GetReference();
+            if (!channel->Open(boost::asio::ip::udp::endpoint(),
+                [sreference, this, stransmission](const std::shared_ptr<frp::messages::Packet>& packet) noexcept {
+                    if (packet->Command == frp::messages::PacketCommands::PacketCommands_WriteTo) {
+                        OnHandleWriteTo(stransmission, *packet);
+                    }
+                })) {
+                return false;
+            }
+
+            DatagramChannelPtr previous;
+            if (frp::collections::Dictionary::TryRemove(channels_, transmission.get(), previous)) {
+                previous->Close();
+            }
+
+            if (!frp::collections::Dictionary::TryAdd(channels_, transmission.get(), channel)) {
+                return false;
+            }
+
+            /* The offer travels the transmission, which is what authenticates the channel. */
+            frp::messages::Packet packet;
+            packet.Command = frp::messages::PacketCommands::PacketCommands_Datagram;
+            packet.Id = (int)channel->GetSession();
+            packet.Offset = 0;
+            packet.Length = (int)secret.size();
+            packet.Buffer = std::shared_ptr<Byte>((Byte*)secret.data(), [](Byte*) noexcept {});
+
+            int messages_size;
+            std::shared_ptr<Byte> message_ = packet.Serialize(messages_size);
+            if (!message_ || messages_size < 1) {
+                return false;
+            }
+
+            return Then(stransmission, stransmission->WriteAsync(message_, 0, messages_size,
+                [stransmission, sreference, this](bool success) noexcept {
+                    Then(stransmission, success);
+                }));
+        }
+
+        bool MappingEntry::AddBatch(const TransmissionPtr& transmission) noexcept {
+            if (disposed_ || !transmission || Type != MappingType::MappingType_UDP) {
+                return false;
+            }
+
+            WriteToBatchPtr batch = make_shared_object<frp::messages::WriteToBatch>();
+            if (!batch) {
+                return false;
+            }
+
+            batches_[transmission.get()] = batch;
+
+            /* An empty batch tells frpc that it may batch too, frpc that never asked does not get one. */
+            frp::messages::Packet packet;
+            packet.Command = frp::messages::PacketCommands::PacketCommands_WriteToBatch;
+            packet.Id = 0;
+            packet.Offset = 0;
+            packet.Length = 0;
+
+            int messages_size;
+            std::shared_ptr<Byte> message_ = packet.Serialize(messages_size);
+            if (!message_ || messages_size < 1) {
+                return false;
+            }
+
+            const TransmissionPtr stransmission = transmission;
+            const std::shared_ptr<Reference> sreference = GetReference();
+            return Then(stransmission, stransmission->WriteAsync(message_, 0, messages_size,
+                [stransmission, sreference, this](bool success) noexcept {
+                    Then(stransmission, success);
+                }));
+        }
     }
 }
\ No newline at end of file
@@ -2,16 +2,19 @@
 
 #include <frp/IDisposable.h>
 #include <frp/threading/Hosting.h>
+#include <frp/net/DatagramBatch.h>
 #include <frp/collections/TransmissionManager.h>
 #include <frp/configuration/MappingConfiguration.h>
 
 namespace frp {
     namespace transmission {
         class ITransmission;
+        class DatagramChannel;
     }
 
     namespace messages {
         class Packet;
+        class WriteToBatch;
     }
 
     namespace server {
@@ -23,6 +26,10 @@ namespace frp {
 
         protected:
             typedef frp::configuration::MappingType                     MappingType;
+            typedef std::shared_ptr<frp::transmission::DatagramChannel> DatagramChannelPtr;
+            typedef std::unordered_map<void*, DatagramChannelPtr>       DatagramChannelTable;
+            typedef std::shared_ptr<frp::messages::WriteToBatch>        WriteToBatchPtr;
+            typedef std::unordered_map<void*, WriteToBatchPtr>          WriteToBatchTable;
 
         public:
             const std::string                                           Name;
@@ -45,8 +52,11 @@ namespace frp {
 
         private:
             bool                                                        ForwardedToFrpClientAsync() noexcept;
+            bool                                                        ForwardedToFrpClientBatchAsync() noexcept;
             bool                                                        PacketInputAsync(const TransmissionPtr& transmission) noexcept;
             bool                                                        SendToFrpClientAsync(const void* buffer, int length, const boost::asio::ip::udp::endpoint& endpoint) noexcept;
+            bool                                                        WriteToBatchAsync(const TransmissionPtr& transmission, const WriteToBatchPtr& batch, const void* buffer, int length, const boost::asio::ip::udp::endpoint& endpoint) noexcept;
+            bool                                                        FlushBatchAsync(const TransmissionPtr& transmission, const WriteToBatchPtr& batch) noexcept;
 
         private:
             bool                                                        Then(const TransmissionPtr& transmission, bool success) noexcept;
@@ -58,6 +68,7 @@ namespace frp {
             bool                                                        OnHandleDisconnect(const TransmissionPtr& transmission, int id) noexcept;
             bool                                                        OnHandleWrite(const TransmissionPtr& transmission, frp::messages::Packet& packet) noexcept;
             bool                                                        OnHandleWriteTo(const TransmissionPtr& transmission, frp::messages::Packet& packet) noexcept;
+            bool                                                        OnHandleWriteToBatch(const TransmissionPtr& transmission, frp::messages::Packet& packet) noexcept;
 
         private:
             bool                                                        AcceptConnection(const std::shared_ptr<boost::asio::ip::tcp::socket>& socket) noexcept;
@@ -65,6 +76,8 @@ namespace frp {
         public:
             int                                                         AddTransmission(const TransmissionPtr& transmission) noexcept;
             void                                                        CloseTransmission(const TransmissionPtr& transmission) noexcept;
+            bool                                                        AddChannel(const TransmissionPtr& transmission, const DatagramChannelPtr& channel, const std::string& secret) noexcept;
+            bool                                                        AddBatch(const TransmissionPtr& transmission) noexcept;
 
         private:
             std::atomic<bool>                                           disposed_;
@@ -75,6 +88,10 @@ namespace frp {
             boost::asio::ip::tcp::acceptor                              acceptor_;
             boost::asio::ip::udp::socket                                socket_;
             boost::asio::ip::udp::endpoint                              endpoint_;
+            frp::net::DatagramBatch                                     batch_;
+            UInt64                                                      dropped_;
+            DatagramChannelTable                                        channels_;
+            WriteToBatchTable                                           batches_;
         };
     }
 }
\ No newline at end of file
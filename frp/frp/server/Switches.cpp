@@ -8,9 +8,14 @@
 #include <frp/threading/Hosting.h>
 #include <frp/transmission/Transmission.h>
 #include <frp/transmission/EncryptorTransmission.h>
+#include <frp/transmission/AeadEncryptorTransmission.h>
 #include <frp/transmission/SslSocketTransmission.h>
 #include <frp/transmission/WebSocketTransmission.h>
 #include <frp/transmission/SslWebSocketTransmission.h>
+#include <frp/transmission/CompressionTransmission.h>
+#include <frp/transmission/ReliableUdpSocket.h>
+#include <frp/transmission/ReliableUdpTransmission.h>
+#include <frp/transmission/DatagramChannel.h>
 
 using frp::net::IPEndPoint;
 using frp::net::Ipep;
@@ -43,6 +48,11 @@ namespace frp {
             if (!disposed_.exchange(true)) {
                 /* Close the TCP socket acceptor function to prevent the system from continuously processing connections. */
                 frp::net::Socket::Closesocket(acceptor_);
+                if (datagram_) {
+                    datagram_->Close();
+                }
+
+                frp::net::Socket::Closesocket(channel_);
 
                 /* Clear all timeouts. */
                 Dictionary::ReleaseAllPairs(timeouts_,
@@ -80,6 +90,33 @@ namespace frp {
             }
 
             const std::shared_ptr<Reference> reference = GetReference();
+            if (configuration_->Protocol == AppConfiguration::ProtocolType_ReliableUdp) {
+                /* The reliable UDP sessions listen on the same port number as the TCP acceptor, one socket carries all of them. */
+                boost::system::error_code ec;
+                datagram_ = NewReference<frp::transmission::ReliableUdpSocket>(context_, configuration_->Protocols.ReliableUdp.Loss);
+                if (!datagram_ || !datagram_->Open(boost::asio::ip::address::from_string(configuration_->IP, ec), port,
+                    [reference, this](UInt32 conv, const boost::asio::ip::udp::endpoint& remoteEP) noexcept {
+                        std::shared_ptr<frp::transmission::ReliableUdpTransmission> transmission =
+                            std::dynamic_pointer_cast<frp::transmission::ReliableUdpTransmission>(CreateTransmission(conv, remoteEP));
+                        if (!transmission) {
+                            return transmission;
+                        }
+
+                        if (!HandshakeAsync(transmission)) {
+                            transmission->Close();
+                            return std::shared_ptr<frp::transmission::ReliableUdpTransmission>();
+                        }
+                        return transmission;
+                    })) {
+                    return false;
+                }
+            }
+
+            /* The datagram channel of the UDP mappings is optional, without it their packets just stay in band. */
+            if (configuration_->Protocols.Datagram && configuration_->Protocol != AppConfiguration::ProtocolType_ReliableUdp) {
+                OpenChannel(port);
+            }
+
             return frp::net::Socket::AcceptLoopbackAsync(hosting_, acceptor_,
                 [reference, this](const std::shared_ptr<boost::asio::io_context>& context, const frp::net::Socket::AsioTcpSocket& socket) noexcept {
                     frp::net::Socket::AdjustSocketOptional(*socket, configuration_->FastOpen, configuration_->Turbo);
@@ -107,7 +144,7 @@ namespace frp {
                             if (length > 0) {
                                 std::shared_ptr<frp::messages::HandshakeRequest> request = frp::messages::HandshakeRequest::Deserialize(buffer.get(), length);
                                 if (request) {
-                                    success = AddEntry(stransmission, request);
+                                    success = AddEntry(CreateTransmission(stransmission, request), request);
                                 }
                             }
 
@@ -125,6 +162,89 @@ namespace frp {
                 });
         }
 
+        bool Switches::OpenChannel(int port) noexcept {
+            boost::system::error_code ec;
+            channel_ = make_shared_object<boost::asio::ip::udp::socket>(*context_);
+            channel_buffer_ = make_shared_alloc<Byte>(frp::threading::Hosting::BufferSize);
+            if (!channel_ || !channel_buffer_) {
+                channel_ = NULL;
+                return false;
+            }
+
+            if (!frp::net::Socket::OpenSocket(*channel_, boost::asio::ip::address::from_string(configuration_->IP, ec), port)) {
+                frp::net::Socket::Closesocket(channel_);
+                channel_ = NULL;
+                return false;
+            }
+            return ReceiveChannelAsync();
+        }
+
+        bool Switches::ReceiveChannelAsync() noexcept {
+            if (disposed_ || !channel_ || !channel_->is_open()) {
+                return false;
+            }
+
+            const std::shared_ptr<Reference> reference = GetReference();
+            channel_->async_receive_from(boost::asio::buffer(channel_buffer_.get(), frp::threading::Hosting::BufferSize), channel_endpoint_,
+                [reference, this](const boost::system::error_code& ec, std::size_t sz) noexcept {
+                    if (ec == boost::system::errc::operation_canceled || disposed_) {
+                        return;
+                    }
+
+                    /* Unknown sessions are dropped without an answer, the channel only ever speaks to who holds the secret. */
+                    UInt32 session = ec ? 0 : frp::transmission::DatagramChannel::GetSession(channel_buffer_.get(), (int)sz);
+                    if (session) {
+                        DatagramChannelTable::iterator tail = channels_.find(session);
+                        if (tail != channels_.end()) {
+                            DatagramChannelPtr channel = tail->second.lock();
+                            if (channel) {
+                                channel->Input(channel_buffer_.get(), (int)sz, channel_endpoint_);
+                            }
+                            else {
+                                channels_.erase(tail);
+                            }
+                        }
+                    }
+                    ReceiveChannelAsync();
+                });
+            return true;
+        }
+
+        Switches::DatagramChannelPtr Switches::CreateChannel(std::string& secret) noexcept {
+            if (!channel_ || !channel_->is_open()) {
+                return NULL;
+            }
+
+            secret = frp::transmission::DatagramChannel::NewSecret();
+            if (secret.empty()) {
+                return NULL;
+            }
+
+            UInt32 session = 0;
+            for (DatagramChannelTable::iterator tail = channels_.begin(); tail != channels_.end();) {
+                if (tail->second.expired()) {
+                    tail = channels_.erase(tail);
+                }
+                else {
+                    tail++;
+                }
+            }
+
+            while (session == 0 || channels_.find(session) != channels_.end()) {
+                if (RAND_bytes((Byte*)&session, sizeof(session)) < 1) {
+                    return NULL;
+                }
+            }
+
+            DatagramChannelPtr channel = NewReference<frp::transmission::DatagramChannel>(hosting_, channel_, session, secret, false, configuration_->Protocols.Fec);
+            if (!channel) {
+                return NULL;
+            }
+
+            channels_[session] = channel;
+            return channel;
+        }
+
         bool Switches::HandshakeAsync(const std::shared_ptr<boost::asio::io_context>& context, const std::shared_ptr<boost::asio::ip::tcp::socket>& socket) noexcept {
             const std::shared_ptr<frp::transmission::ITransmission> transmission = CreateTransmission(context, socket);
             if (!transmission) {
@@ -165,28 +285,41 @@ namespace frp {
                     configuration_->Protocols.Ssl.CertificateKeyFile,
                     configuration_->Protocols.Ssl.CertificateChainFile,
                     configuration_->Protocols.Ssl.CertificateKeyPassword,
-                    configuration_->Protocols.Ssl.Ciphersuites);
+                    configuration_->Protocols.Ssl.Ciphersuites,
+                    configuration_->Protocols.Ssl.SessionTicketKeyFile,
+                    configuration_->Protocols.Ssl.EarlyData,
+                    configuration_->Protocols.Ssl.Ktls);
+            }
+            elif(configuration_->Protocol == AppConfiguration::ProtocolType_Encryptor && configuration_->Protocols.Encryptor.Aead) {
+                transmission = NewReference2<frp::transmission::ITransmission, frp::transmission::AeadEncryptorTransmission>(hosting_, context, socket,
+                    configuration_->Protocols.Encryptor.Method,
+                    configuration_->Protocols.Encryptor.Password,
+                    configuration_->Protocols.Encryptor.Pipeline);
             }
             elif(configuration_->Protocol == AppConfiguration::ProtocolType_Encryptor) {
                 transmission = NewReference2<frp::transmission::ITransmission, frp::transmission::EncryptorTransmission>(hosting_, context, socket,
                     configuration_->Protocols.Encryptor.Method,
-                    configuration_->Protocols.Encryptor.Password);
+                    configuration_->Protocols.Encryptor.Password,
+                    configuration_->Protocols.Encryptor.Pipeline);
             }
             elif(configuration_->Protocol == AppConfiguration::ProtocolType_WebSocket) {
                 transmission = NewReference2<frp::transmission::ITransmission, frp::transmission::WebSocketTransmission>(hosting_, context, socket,
                     configuration_->Protocols.WebSocket.Host,
-                    configuration_->Protocols.WebSocket.Path);
+                    configuration_->Protocols.WebSocket.Path,
+                    configuration_->Protocols.WebSocket.Compression);
             }
             elif(configuration_->Protocol == AppConfiguration::ProtocolType_WebSocket_SSL ||
                 configuration_->Protocol == AppConfiguration::ProtocolType_WebSocket_TLS) {
                 transmission = NewReference2<frp::transmission::ITransmission, frp::transmission::SslWebSocketTransmission>(hosting_, context, socket,
                     configuration_->Protocols.WebSocket.Host,
                     configuration_->Protocols.WebSocket.Path,
+                    configuration_->Protocols.WebSocket.Compression,
                     configuration_->Protocols.Ssl.CertificateFile,
                     configuration_->Protocols.Ssl.CertificateKeyFile,
                     configuration_->Protocols.Ssl.CertificateChainFile,
                     configuration_->Protocols.Ssl.CertificateKeyPassword,
-                    configuration_->Protocols.Ssl.Ciphersuites);
+                    configuration_->Protocols.Ssl.Ciphersuites,
+                    configuration_->Protocols.Ssl.SessionTicketKeyFile);
             }
             else {
                 transmission = NewReference2<frp::transmission::ITransmission, frp::transmission::Transmission>(hosting_, context, socket);
@@ -194,6 +327,35 @@ namespace frp {
             return transmission->Constructor(transmission);
         }
 
+        std::shared_ptr<frp::transmission::ITransmission> Switches::CreateTransmission(UInt32 conv, const boost::asio::ip::udp::endpoint& remoteEP) noexcept {
+            if (!datagram_) {
+                return NULL;
+            }
+
+            std::shared_ptr<frp::transmission::ITransmission> transmission = NewReference2<frp::transmission::ITransmission, frp::transmission::ReliableUdpTransmission>(hosting_, context_, datagram_,
+                conv,
+                remoteEP,
+                configuration_->Protocols.ReliableUdp,
+                false);
+            if (!transmission) {
+                return NULL;
+            }
+            return transmission->Constructor(transmission);
+        }
+
+        std::shared_ptr<frp::transmission::ITransmission> Switches::CreateTransmission(const std::shared_ptr<frp::transmission::ITransmission>& transmission, const std::shared_ptr<frp::messages::HandshakeRequest>& request) noexcept {
+            /* Only when both ends want it, frpc keeps writing plain packets until it reads the acknowledgement. */
+            if (!configuration_->Protocols.Compression || !(request->Features & frp::messages::HandshakeRequest::HandshakeFeatures_Compression)) {
+                return transmission;
+            }
+
+            std::shared_ptr<frp::transmission::CompressionTransmission> compression = NewReference<frp::transmission::CompressionTransmission>(transmission);
+            if (!compression || !compression->Constructor(compression) || !compression->AcknowledgeAsync()) {
+                return transmission;
+            }
+            return compression;
+        }
+
         bool Switches::CloseEntry(MappingType type, int port) noexcept {
             if ((int)type < MappingType::MappingType_None || (int)type >= MappingType::MappingType_MaxType) {
                 return false;
@@ -236,9 +398,21 @@ namespace frp {
                 entry->Close();
                 return false;
             }
-            else {
-                return status > 0;
+
+            /* frpc understands batched WriteTo frames, answer with an empty one so that it uses them as well. */
+            if (status > 0 && request->Type == MappingType::MappingType_UDP && (request->Features & frp::messages::HandshakeRequest::HandshakeFeatures_WriteToBatch)) {
+                entry->AddBatch(transmission);
+            }
+
+            /* frpc asked for the datagram channel and this frps has one. */
+            if (status > 0 && request->Type == MappingType::MappingType_UDP && (request->Features & frp::messages::HandshakeRequest::HandshakeFeatures_Datagram)) {
+                std::string secret;
+                DatagramChannelPtr channel = CreateChannel(secret);
+                if (channel && !entry->AddChannel(transmission, channel, secret)) {
+                    channel->Close();
+                }
             }
+            return status > 0;
         }
     }
 }
\ No newline at end of file
@@ -14,6 +14,11 @@ namespace frp {
         class HandshakeRequest;
     }
 
+    namespace transmission {
+        class ReliableUdpSocket;
+        class DatagramChannel;
+    }
+
     namespace server {
         class MappingEntry;
 
@@ -24,6 +29,8 @@ namespace frp {
             typedef std::unordered_map<int, MappingEntryPtr>                MappingEntryTable;
             typedef std::shared_ptr<boost::asio::deadline_timer>            TimeoutPtr;
             typedef std::unordered_map<void*, TimeoutPtr>                   TimeoutTable;
+            typedef std::shared_ptr<frp::transmission::DatagramChannel>     DatagramChannelPtr;
+            typedef std::unordered_map<UInt32, std::weak_ptr<frp::transmission::DatagramChannel> > DatagramChannelTable;
 
         public:
             typedef frp::configuration::MappingType                         MappingType;
@@ -54,13 +61,18 @@ namespace frp {
         protected:
             virtual bool                                                    HandshakeAsync(const std::shared_ptr<frp::transmission::ITransmission>& transmission) noexcept;
             virtual std::shared_ptr<frp::transmission::ITransmission>       CreateTransmission(const std::shared_ptr<boost::asio::io_context>& context, const std::shared_ptr<boost::asio::ip::tcp::socket>& socket) noexcept;
+            virtual std::shared_ptr<frp::transmission::ITransmission>       CreateTransmission(UInt32 conv, const boost::asio::ip::udp::endpoint& remoteEP) noexcept;
+            virtual std::shared_ptr<frp::transmission::ITransmission>       CreateTransmission(const std::shared_ptr<frp::transmission::ITransmission>& transmission, const std::shared_ptr<frp::messages::HandshakeRequest>& request) noexcept;
             virtual bool                                                    AddEntry(const std::shared_ptr<frp::transmission::ITransmission>& transmission, const std::shared_ptr<frp::messages::HandshakeRequest>& request) noexcept;
             virtual bool                                                    CloseEntry(MappingType type, int port) noexcept;
+            virtual DatagramChannelPtr                                      CreateChannel(std::string& secret) noexcept;
 
         private:
             bool                                                            HandshakeAsync(const std::shared_ptr<boost::asio::io_context>& context, const std::shared_ptr<boost::asio::ip::tcp::socket>& socket) noexcept;
             bool                                                            ClearTimeout(void* key) noexcept;
             bool                                                            AddTimeout(void* key, std::shared_ptr<boost::asio::deadline_timer>&& timeout) noexcept;
+            bool                                                            OpenChannel(int port) noexcept;
+            bool                                                            ReceiveChannelAsync() noexcept;
 
         private:
             std::atomic<bool>                                               disposed_;
@@ -68,6 +80,11 @@ namespace frp {
             std::shared_ptr<frp::threading::Hosting>                        hosting_;
             std::shared_ptr<boost::asio::io_context>                        context_;
             boost::asio::ip::tcp::acceptor                                  acceptor_;
+            std::shared_ptr<frp::transmission::ReliableUdpSocket>           datagram_;
+            std::shared_ptr<boost::asio::ip::udp::socket>                   channel_;
+            std::shared_ptr<Byte>                                           channel_buffer_;
+            boost::asio::ip::udp::endpoint                                  channel_endpoint_;
+            DatagramChannelTable                                            channels_;
             TimeoutTable                                                    timeouts_;
             MappingEntryTable                                               entiress_[MappingType::MappingType_MaxType];
         };
@@ -1,9 +1,108 @@
 #include <frp/ssl/root_certificates.hpp>
 #include <frp/ssl/SSL.h>
+#include <frp/ssl/SslHandshake.h>
 #include <frp/io/File.h>
 
 namespace frp {
     namespace ssl {
+        typedef std::mutex                                                  SslContextMutex;
+        typedef std::lock_guard<SslContextMutex>                            SslContextMutexScope;
+
+        struct SslContextEntry {
+            std::shared_ptr<boost::asio::ssl::context>                      context;
+            std::string                                                     stamp;
+            uint64_t                                                        last;
+        };
+        typedef std::unordered_map<std::string, SslContextEntry>            SslContextTable;
+
+        /* Certificate files are probed for changes at most once per interval, not on every handshake. */
+        static const uint64_t                                               SSL_CONTEXT_RELOAD_INTERVAL = 1000;
+        static SslContextMutex                                              SSL_CONTEXT_LOCK;
+        static SslContextTable                                              SSL_CONTEXT_TABLE;
+
+        /* Sessions received from each frps (keyed by SNI host and server endpoint) for resumption on reconnect. */
+        typedef std::unordered_map<std::string, SSL_SESSION*>               SslSessionTable;
+
+        static const int                                                    SSL_SESSION_CACHE_CAPACITY = 1024;
+        static const long                                                   SSL_SESSION_TICKET_TIMEOUT = 7200;
+        static const int                                                    SSL_SESSION_TICKET_KEYS_SIZE = 80;
+        static SslContextMutex                                              SSL_SESSION_LOCK;
+        static SslSessionTable                                              SSL_SESSION_TABLE;
+
+        static void SSL_FreeSessionKey(void* parent, void* ptr, CRYPTO_EX_DATA* ad, int idx, long argl, void* argp) noexcept {
+            std::string* key = (std::string*)ptr;
+            if (NULL != key) {
+                delete key;
+            }
+        }
+
+        static int SSL_GetSessionKeyIndex() noexcept {
+            static const int index = SSL_get_ex_new_index(0, NULL, NULL, NULL, SSL_FreeSessionKey);
+            return index;
+        }
+
+        static int SSL_OnNewClientSession(::SSL* ssl, SSL_SESSION* session) noexcept {
+            std::string* key = (std::string*)SSL_get_ex_data(ssl, SSL_GetSessionKeyIndex());
+            if (NULL == key || !SSL_SESSION_is_resumable(session)) {
+                return 0;
+            }
+
+            SslContextMutexScope scope(SSL_SESSION_LOCK);
+            SslSessionTable::iterator tail = SSL_SESSION_TABLE.find(*key);
+            if (tail != SSL_SESSION_TABLE.end()) {
+                SSL_SESSION_free(tail->second);
+                tail->second = session;
+                return 1;
+            }
+
+            if (SSL_SESSION_TABLE.size() >= SSL_SESSION_CACHE_CAPACITY) {
+                tail = SSL_SESSION_TABLE.begin();
+                SSL_SESSION_free(tail->second);
+                SSL_SESSION_TABLE.erase(tail);
+            }
+
+            /* Returning 1 keeps the reference OpenSSL handed over to us. */
+            SSL_SESSION_TABLE[*key] = session;
+            return 1;
+        }
+
+        static bool SSL_LoadSessionTicketKeys(SSL_CTX* ctx, const std::string& session_ticket_key_file) noexcept {
+            int length;
+            std::shared_ptr<Byte> content = frp::io::File::ReadAllBytes(session_ticket_key_file.data(), length);
+            if (!content || length < 1) {
+                return false;
+            }
+
+            /* Every frps sharing the key file (or restarting with it) derives the same ticket name, HMAC and AES keys. */
+            static const char salt[] = "frp/session-ticket-keys";
+            Byte keys[SSL_SESSION_TICKET_KEYS_SIZE];
+            if (PKCS5_PBKDF2_HMAC((char*)content.get(), length, (Byte*)salt, sizeof(salt) - 1, 1000, EVP_sha256(), sizeof(keys), keys) < 1) {
+                return false;
+            }
+
+            bool success = SSL_CTX_set_tlsext_ticket_keys(ctx, keys, sizeof(keys)) > 0;
+            OPENSSL_cleanse(keys, sizeof(keys));
+            return success;
+        }
+
+        static std::string SSL_GetCertificateStamp(const std::string* files, int count) noexcept {
+            typedef frp::io::File File;
+
+            std::string stamp;
+            for (int i = 0; i < count; i++) {
+                const char* path = files[i].data();
+                if (files[i].empty()) {
+                    continue;
+                }
+
+                stamp += std::to_string(File::GetLastWriteTime(path));
+                stamp += ":";
+                stamp += std::to_string(File::GetLength(path));
+                stamp += ";";
+            }
+            return stamp;
+        }
+
         boost::asio::ssl::context::method SSL::SSL_S_METHOD(int method) noexcept {
             switch (method) {
             case SSL_METHOD::tlsv13:
@@ -96,7 +195,9 @@ namespace frp {
             const std::string& certificate_key_file,
             const std::string& certificate_chain_file,
             const std::string& certificate_key_password,
-            const std::string& ciphersuites) noexcept {
+            const std::string& ciphersuites,
+            const std::string& session_ticket_key_file,
+            bool early_data) noexcept {
             std::shared_ptr<boost::asio::ssl::context> ssl_context = make_shared_object<boost::asio::ssl::context>(
                 frp::ssl::SSL::SSL_S_METHOD(method));
             if (!ssl_context) {
@@ -134,6 +235,22 @@ namespace frp {
                 SSL_CTX_set_ciphersuites(ssl_context->native_handle(), ciphersuites.data());
             }
             SSL_CTX_set_ecdh_auto(ssl_context->native_handle(), 1);
+
+            // Issue session tickets so reconnecting frp clients can resume without the certificate exchange.
+            SSL_CTX* ctx = ssl_context->native_handle();
+            SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+            SSL_CTX_set_session_id_context(ctx, (Byte*)"frp", 3);
+            SSL_CTX_set_timeout(ctx, SSL_SESSION_TICKET_TIMEOUT);
+            if (session_ticket_key_file.size()) {
+                if (!SSL_LoadSessionTicketKeys(ctx, session_ticket_key_file)) {
+                    return NULL;
+                }
+            }
+
+            // Tickets advertise 0-RTT, OpenSSL keeps the anti-replay window in the server session cache.
+            if (early_data) {
+                SSL_CTX_set_max_early_data(ctx, SslHandshake::MAX_EARLY_DATA);
+            }
             return ssl_context;
         }
 
@@ -165,9 +282,112 @@ namespace frp {
                 SSL_CTX_set_ciphersuites(ssl_context->native_handle(), ciphersuites.data());
             }
             SSL_CTX_set_ecdh_auto(ssl_context->native_handle(), 1);
+
+            // Sessions are kept outside of OpenSSL per frp server, see SetClientSession.
+            SSL_CTX* ctx = ssl_context->native_handle();
+            SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+            SSL_CTX_sess_set_new_cb(ctx, SSL_OnNewClientSession);
             return ssl_context;
         }
 
+        bool SSL::SetClientSession(::SSL* ssl, const std::string& key) noexcept {
+            if (NULL == ssl || key.empty()) {
+                return false;
+            }
+
+            std::string* value = new std::string(key);
+            if (!SSL_set_ex_data(ssl, SSL_GetSessionKeyIndex(), value)) {
+                delete value;
+                return false;
+            }
+
+            SslContextMutexScope scope(SSL_SESSION_LOCK);
+            SslSessionTable::iterator tail = SSL_SESSION_TABLE.find(key);
+            if (tail == SSL_SESSION_TABLE.end()) {
+                return false;
+            }
+
+            /* OpenSSL marks the session unusable when its connection was not shut down cleanly. */
+            SSL_SESSION* session = tail->second;
+            if (!SSL_SESSION_is_resumable(session)) {
+                SSL_SESSION_free(session);
+                SSL_SESSION_TABLE.erase(tail);
+                return false;
+            }
+            return SSL_set_session(ssl, session) > 0;
+        }
+
+        std::shared_ptr<boost::asio::ssl::context> SSL::GetServerSslContext(
+            int method,
+            const std::string& certificate_file,
+            const std::string& certificate_key_file,
+            const std::string& certificate_chain_file,
+            const std::string& certificate_key_password,
+            const std::string& ciphersuites,
+            const std::string& session_ticket_key_file,
+            bool early_data) noexcept {
+            const std::string files[] = { certificate_file, certificate_key_file, certificate_chain_file, session_ticket_key_file };
+            const std::string key = "server\n" + std::to_string(method) + "\n" + certificate_file + "\n" + certificate_key_file + "\n" +
+                certificate_chain_file + "\n" + certificate_key_password + "\n" + ciphersuites + "\n" + session_ticket_key_file + "\n" + std::to_string(early_data);
+
+            SslContextMutexScope scope(SSL_CONTEXT_LOCK);
+            SslContextEntry& entry = SSL_CONTEXT_TABLE[key];
+
+            uint64_t now = GetTickCount();
+            if (entry.context && (now - entry.last) < SSL_CONTEXT_RELOAD_INTERVAL) {
+                return entry.context;
+            }
+
+            entry.last = now;
+            std::string stamp = SSL_GetCertificateStamp(files, arraysizeof(files));
+            if (entry.context && entry.stamp == stamp) {
+                return entry.context;
+            }
+
+            /* Build the replacement aside and only publish it when the certificate and key load and match,
+             * a half-written file keeps the previous context in service until the next probe.
+             */
+            std::shared_ptr<boost::asio::ssl::context> ssl_context = CreateServerSslContext(method,
+                certificate_file, certificate_key_file, certificate_chain_file, certificate_key_password, ciphersuites, session_ticket_key_file, early_data);
+            if (ssl_context) {
+                SSL_CTX* ctx = ssl_context->native_handle();
+                if (NULL == SSL_CTX_get0_certificate(ctx) || SSL_CTX_check_private_key(ctx) != 1) {
+                    ssl_context = NULL;
+                }
+            }
+
+            if (!ssl_context) {
+                if (entry.context) {
+                    LOG_ERROR("Unable to reload the ssl certificate %s, the previous certificate is still used.", certificate_file.data());
+                }
+                return entry.context;
+            }
+
+            if (entry.context) {
+                LOG_INFO("The ssl certificate %s has been reloaded.", certificate_file.data());
+            }
+
+            /* Transmissions already handshaking hold their own reference to the previous context. */
+            entry.stamp = stamp;
+            entry.context = ssl_context;
+            return ssl_context;
+        }
+
+        std::shared_ptr<boost::asio::ssl::context> SSL::GetClientSslContext(
+            int method,
+            bool verify_peer,
+            const std::string& ciphersuites) noexcept {
+            const std::string key = "client\n" + std::to_string(method) + "\n" + (verify_peer ? "1" : "0") + "\n" + ciphersuites;
+
+            SslContextMutexScope scope(SSL_CONTEXT_LOCK);
+            SslContextEntry& entry = SSL_CONTEXT_TABLE[key];
+            if (!entry.context) {
+                entry.context = CreateClientSslContext(method, verify_peer, ciphersuites);
+                entry.last = GetTickCount();
+            }
+            return entry.context;
+        }
+
         const char* SSL::GetSslCiphersuites() noexcept {
 #if !(defined(__aarch64__) || defined(_M_ARM64))
             if (strstr(GetPlatformCode(), "ARM")) {
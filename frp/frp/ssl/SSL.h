@@ -33,11 +33,29 @@ namespace frp {
                 const std::string&                                          certificate_key_file,
                 const std::string&                                          certificate_chain_file,
                 const std::string&                                          certificate_key_password,
-                const std::string&                                          ciphersuites) noexcept;
+                const std::string&                                          ciphersuites,
+                const std::string&                                          session_ticket_key_file,
+                bool                                                        early_data) noexcept;
             static std::shared_ptr<boost::asio::ssl::context>               CreateClientSslContext(
                 int                                                         method,
                 bool                                                        verify_peer,
                 const std::string&                                          ciphersuites) noexcept;
+
+        public:
+            static std::shared_ptr<boost::asio::ssl::context>               GetServerSslContext(
+                int                                                         method,
+                const std::string&                                          certificate_file,
+                const std::string&                                          certificate_key_file,
+                const std::string&                                          certificate_chain_file,
+                const std::string&                                          certificate_key_password,
+                const std::string&                                          ciphersuites,
+                const std::string&                                          session_ticket_key_file,
+                bool                                                        early_data) noexcept;
+            static std::shared_ptr<boost::asio::ssl::context>               GetClientSslContext(
+                int                                                         method,
+                bool                                                        verify_peer,
+                const std::string&                                          ciphersuites) noexcept;
+            static bool                                                     SetClientSession(::SSL* ssl, const std::string& key) noexcept;
         };
     }
 }
\ No newline at end of file
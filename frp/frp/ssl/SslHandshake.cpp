@@ -0,0 +1,280 @@
+#include <frp/ssl/SslHandshake.h>
+#include <frp/threading/WorkerPool.h>
+
+namespace frp {
+    namespace ssl {
+        SslHandshake::SslHandshake(::SSL* ssl, boost::asio::ip::tcp::socket& socket) noexcept
+            : ssl_(ssl)
+            , bio_(NULL)
+            , socket_(socket)
+            , step_(HandshakeStep_Handshake)
+            , ktls_(false)
+            , kernel_tls_(false)
+            , early_data_size_(0)
+            , early_data_offset_(0) {
+
+        }
+
+        SslHandshake::~SslHandshake() noexcept {
+            BIO* bio = bio_;
+            if (NULL != bio) {
+                bio_ = NULL;
+                BIO_free(bio);
+            }
+        }
+
+        bool SslHandshake::HandshakeAsync(bool client, const std::shared_ptr<Byte>& early_data, int early_data_size, const BOOST_ASIO_MOVE_ARG(HandshakeAsyncCallback) callback) noexcept {
+            if (!callback || NULL == ssl_ || NULL != bio_) {
+                return false;
+            }
+
+            if (!socket_.is_open()) {
+                return false;
+            }
+
+            if (client) {
+                /* Only a resumed session whose ticket allows enough early data can carry it, anything else is a plain handshake. */
+                SSL_SESSION* session = SSL_get_session(ssl_);
+                if (early_data && early_data_size > 0 && NULL != session && SSL_SESSION_get_max_early_data(session) >= (UInt32)early_data_size) {
+                    early_data_ = early_data;
+                    early_data_size_ = early_data_size;
+                    step_ = HandshakeStep_WriteEarlyData;
+                }
+            }
+            elif(SSL_get_max_early_data(ssl_) > 0) {
+                early_data_ = make_shared_alloc<Byte>(MAX_EARLY_DATA);
+                if (!early_data_) {
+                    return false;
+                }
+                step_ = HandshakeStep_ReadEarlyData;
+            }
+
+            boost::system::error_code ec;
+            socket_.native_non_blocking(true, ec);
+            if (ec) {
+                return false;
+            }
+
+            /* The workers get a descriptor of their own: once the loop closes the socket in the middle of a step,
+             * the number may be handed out again right away, but the duplicate still points at this connection.
+             */
+            BIO* bio = NULL;
+#ifdef _WIN32
+            bio = BIO_new_socket(socket_.native_handle(), BIO_NOCLOSE);
+#else
+            if (workers_) {
+                int fd = dup(socket_.native_handle());
+                if (fd != -1) {
+                    bio = BIO_new_socket(fd, BIO_CLOSE);
+                    if (NULL == bio) {
+                        close(fd);
+                    }
+                }
+            }
+            else {
+                bio = BIO_new_socket(socket_.native_handle(), BIO_NOCLOSE);
+            }
+#endif
+            if (NULL == bio) {
+                return false;
+            }
+
+            /* Keep the BIO of the asio stream alive while the socket BIO stands in for it. */
+            bio_ = SSL_get_rbio(ssl_);
+            if (NULL == bio_ || !BIO_up_ref(bio_)) {
+                bio_ = NULL;
+                BIO_free(bio);
+                return false;
+            }
+
+            SSL_set_bio(ssl_, bio, bio);
+            if (client) {
+                SSL_set_connect_state(ssl_);
+            }
+            else {
+                SSL_set_accept_state(ssl_);
+            }
+
+            callback_ = BOOST_ASIO_MOVE_CAST(HandshakeAsyncCallback)(constantof(callback));
+            Next();
+            return true;
+        }
+
+        void SslHandshake::Next() noexcept {
+            const std::shared_ptr<frp::threading::WorkerPool> workers = workers_;
+            if (!workers) {
+                Complete(Step());
+                return;
+            }
+
+            /* The SSL is only ever touched by one side at a time, the post in either direction orders the hand over.
+             * The reference moves along with it, the last one must never be dropped on a worker.
+             */
+            std::shared_ptr<Reference> reference = GetReference();
+            bool posted = workers->Post(
+                [reference, this]() mutable noexcept {
+                    HandshakeStatus status = Step();
+                    boost::asio::post(socket_.get_executor(), std::bind(
+                        [this, status](std::shared_ptr<Reference>& reference) noexcept {
+                            Complete(status);
+                        }, std::move(reference)));
+                });
+            if (!posted) {
+                Finish(false);
+            }
+        }
+
+        SslHandshake::HandshakeStatus SslHandshake::Step() noexcept {
+            for (;;) {
+                int status;
+                if (step_ == HandshakeStep_WriteEarlyData) {
+                    std::size_t written = 0;
+                    status = SSL_write_early_data(ssl_, early_data_.get() + early_data_offset_, early_data_size_ - early_data_offset_, &written);
+                    if (status > 0) {
+                        early_data_offset_ += (int)written;
+                        if (early_data_offset_ >= early_data_size_) {
+                            step_ = HandshakeStep_Handshake;
+                        }
+                        continue;
+                    }
+                }
+                elif(step_ == HandshakeStep_ReadEarlyData) {
+                    int remain = MAX_EARLY_DATA - early_data_size_;
+                    if (remain < 1) {
+                        return HandshakeStatus_Failure;
+                    }
+
+                    std::size_t readbytes = 0;
+                    status = SSL_read_early_data(ssl_, early_data_.get() + early_data_size_, remain, &readbytes);
+                    if (status == SSL_READ_EARLY_DATA_SUCCESS) {
+                        early_data_size_ += (int)readbytes;
+                        continue;
+                    }
+                    elif(status == SSL_READ_EARLY_DATA_FINISH) {
+                        step_ = HandshakeStep_Handshake;
+                        continue;
+                    }
+                }
+                else {
+                    status = SSL_do_handshake(ssl_);
+                    if (status == 1) {
+                        return HandshakeStatus_Success;
+                    }
+                }
+
+                switch (SSL_get_error(ssl_, status)) {
+                case SSL_ERROR_WANT_READ:
+                    return HandshakeStatus_WantRead;
+                case SSL_ERROR_WANT_WRITE:
+                    return HandshakeStatus_WantWrite;
+                default:
+                    return HandshakeStatus_Failure;
+                }
+            }
+        }
+
+        void SslHandshake::Complete(HandshakeStatus status) noexcept {
+            boost::asio::ip::tcp::socket::wait_type wait_type;
+            switch (status) {
+            case HandshakeStatus_WantRead:
+                wait_type = boost::asio::ip::tcp::socket::wait_read;
+                break;
+            case HandshakeStatus_WantWrite:
+                wait_type = boost::asio::ip::tcp::socket::wait_write;
+                break;
+            default:
+                Finish(status == HandshakeStatus_Success);
+                return;
+            }
+
+            if (!socket_.is_open()) {
+                Finish(false);
+                return;
+            }
+
+            const std::shared_ptr<Reference> reference = GetReference();
+            socket_.async_wait(wait_type,
+                [reference, this](const boost::system::error_code& ec) noexcept {
+                    if (ec) {
+                        Finish(false);
+                    }
+                    else {
+                        Next();
+                    }
+                });
+        }
+
+        void SslHandshake::Finish(bool success) noexcept {
+            /* Hand the asio stream its BIO back, the socket BIO owns a duplicate descriptor at most. */
+            BIO* bio = bio_;
+            if (NULL != bio) {
+                bio_ = NULL;
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+                if (success && ktls_ && (BIO_get_ktls_send(SSL_get_wbio(ssl_)) || BIO_get_ktls_recv(SSL_get_rbio(ssl_)))) {
+                    kernel_tls_ = true;
+                    BIO_free(bio);
+                }
+                else {
+                    SSL_set_bio(ssl_, bio, bio);
+                }
+#else
+                SSL_set_bio(ssl_, bio, bio);
+#endif
+            }
+
+            /* SslSocketStream relies on the descriptor staying non-blocking. */
+            if (!kernel_tls_) {
+                boost::system::error_code ec;
+                socket_.native_non_blocking(false, ec);
+            }
+
+            HandshakeAsyncCallback callback = std::move(callback_);
+            callback_ = NULL;
+            if (callback) {
+                callback(success);
+            }
+        }
+
+        bool SslHandshake::SetKernelTls() noexcept {
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+            if (NULL == ssl_ || NULL != bio_) {
+                return false;
+            }
+
+            /* OpenSSL pushes the traffic keys into the kernel (TLS_TX/TLS_RX) when the cipher and the kernel allow it. */
+            SSL_set_options(ssl_, SSL_OP_ENABLE_KTLS);
+            ktls_ = true;
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        bool SslHandshake::SetWorkers(const std::shared_ptr<frp::threading::WorkerPool>& workers) noexcept {
+            if (NULL != bio_) {
+                return false;
+            }
+
+            workers_ = workers;
+            return NULL != workers;
+        }
+
+        bool SslHandshake::IsKernelTls() noexcept {
+            return kernel_tls_;
+        }
+
+        bool SslHandshake::IsEarlyDataAccepted() noexcept {
+            return SSL_get_early_data_status(ssl_) == SSL_EARLY_DATA_ACCEPTED;
+        }
+
+        std::shared_ptr<Byte> SslHandshake::GetEarlyData(int& length) noexcept {
+            length = 0;
+            if (step_ != HandshakeStep_Handshake || early_data_size_ < 1) {
+                return NULL;
+            }
+
+            length = early_data_size_;
+            return early_data_;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <frp/stdafx.h>
+#include <frp/Reference.h>
+
+namespace frp {
+    namespace threading {
+        class WorkerPool;
+    }
+}
+
+namespace frp {
+    namespace ssl {
+        /* Drives the OpenSSL handshake straight on the TCP socket, for the TLS 1.3 paths (early data, kTLS) asio's stream engine has no hook for.
+         * The stream's own BIO is parked for the duration and handed back once the handshake is over, so the asio stream carries on as usual,
+         * unless the kernel took over the record layer, then the socket BIO stays and I/O goes through SslSocketStream.
+         * Given a worker pool, the OpenSSL calls (the RSA/ECDHE signatures) run on the workers and only the waiting is left to the loop.
+         */
+        class SslHandshake final : public Reference {
+        public:
+            typedef std::function<void(bool)>                               HandshakeAsyncCallback;
+
+        public:
+            static const int                                                MAX_EARLY_DATA = 16384;
+
+        public:
+            SslHandshake(::SSL* ssl, boost::asio::ip::tcp::socket& socket) noexcept;
+            ~SslHandshake() noexcept;
+
+        public:
+            bool                                                            HandshakeAsync(
+                bool                                                        client,
+                const std::shared_ptr<Byte>&                                early_data,
+                int                                                         early_data_size,
+                const BOOST_ASIO_MOVE_ARG(HandshakeAsyncCallback)           callback) noexcept;
+            bool                                                            SetKernelTls() noexcept;
+            bool                                                            SetWorkers(const std::shared_ptr<frp::threading::WorkerPool>& workers) noexcept;
+            bool                                                            IsKernelTls() noexcept;
+            bool                                                            IsEarlyDataAccepted() noexcept;
+            std::shared_ptr<Byte>                                           GetEarlyData(int& length) noexcept;
+
+        private:
+            typedef enum {
+                HandshakeStep_WriteEarlyData,
+                HandshakeStep_ReadEarlyData,
+                HandshakeStep_Handshake,
+            }                                                               HandshakeStep;
+            typedef enum {
+                HandshakeStatus_WantRead,
+                HandshakeStatus_WantWrite,
+                HandshakeStatus_Success,
+                HandshakeStatus_Failure,
+            }                                                               HandshakeStatus;
+
+        private:
+            void                                                            Next() noexcept;
+            HandshakeStatus                                                 Step() noexcept;
+            void                                                            Complete(HandshakeStatus status) noexcept;
+            void                                                            Finish(bool success) noexcept;
+
+        private:
+            ::SSL*                                                          ssl_;
+            BIO*                                                            bio_;
+            boost::asio::ip::tcp::socket&                                   socket_;
+            HandshakeStep                                                   step_;
+            bool                                                            ktls_;
+            bool                                                            kernel_tls_;
+            std::shared_ptr<Byte>                                           early_data_;
+            int                                                             early_data_size_;
+            int                                                             early_data_offset_;
+            std::shared_ptr<frp::threading::WorkerPool>                     workers_;
+            HandshakeAsyncCallback                                          callback_;
+        };
+    }
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <frp/stdafx.h>
+
+namespace frp {
+    namespace ssl {
+        /* An asio AsyncReadStream/AsyncWriteStream over an SSL whose BIO is the socket itself (see SslHandshake::SetKernelTls).
+         * With kTLS the calls below hand plaintext straight to the kernel, OpenSSL only steps in for control records.
+         */
+        class SslSocketStream final {
+        public:
+            typedef boost::asio::ip::tcp::socket::executor_type             executor_type;
+
+        public:
+            inline SslSocketStream(::SSL* ssl, boost::asio::ip::tcp::socket& socket) noexcept
+                : ssl_(ssl)
+                , socket_(socket) {
+
+            }
+
+        public:
+            inline executor_type                                            get_executor() noexcept {
+                return socket_.get_executor();
+            }
+            inline ::SSL*                                                   native_handle() noexcept {
+                return ssl_;
+            }
+            inline boost::asio::ip::tcp::socket&                            next_layer() noexcept {
+                return socket_;
+            }
+            template<typename MutableBufferSequence, typename ReadHandler>
+            inline void                                                     async_read_some(const MutableBufferSequence& buffers, BOOST_ASIO_MOVE_ARG(ReadHandler) handler) noexcept {
+                const boost::asio::mutable_buffer buffer = *boost::asio::buffer_sequence_begin(buffers);
+                Perform(false, buffer.data(), buffer.size(), handler);
+            }
+            template<typename ConstBufferSequence, typename WriteHandler>
+            inline void                                                     async_write_some(const ConstBufferSequence& buffers, BOOST_ASIO_MOVE_ARG(WriteHandler) handler) noexcept {
+                const boost::asio::const_buffer buffer = *boost::asio::buffer_sequence_begin(buffers);
+                Perform(true, const_cast<void*>(buffer.data()), buffer.size(), handler);
+            }
+
+        private:
+            template<typename Handler>
+            inline void                                                     Perform(bool write, void* data, std::size_t size, const Handler& handler) noexcept {
+                std::size_t transferred = 0;
+                int status = size < 1 ? 1 : write ? SSL_write_ex(ssl_, data, size, &transferred) : SSL_read_ex(ssl_, data, size, &transferred);
+                if (status > 0) {
+                    Complete(handler, boost::system::error_code(), transferred);
+                    return;
+                }
+
+                boost::asio::ip::tcp::socket::wait_type wait_type;
+                switch (SSL_get_error(ssl_, status)) {
+                case SSL_ERROR_WANT_READ:
+                    wait_type = boost::asio::ip::tcp::socket::wait_read;
+                    break;
+                case SSL_ERROR_WANT_WRITE:
+                    wait_type = boost::asio::ip::tcp::socket::wait_write;
+                    break;
+                case SSL_ERROR_ZERO_RETURN:
+                    Complete(handler, boost::asio::error::eof, 0);
+                    return;
+                default:
+                    Complete(handler, boost::asio::error::connection_reset, 0);
+                    return;
+                }
+
+                /* OpenSSL wants the very same arguments again once the socket is ready. */
+                Handler handler_ = handler;
+                socket_.async_wait(wait_type,
+                    [this, write, data, size, handler_](const boost::system::error_code& ec) mutable noexcept {
+                        if (ec) {
+                            handler_(ec, 0);
+                        }
+                        else {
+                            Perform(write, data, size, handler_);
+                        }
+                    });
+            }
+            template<typename Handler>
+            inline void                                                     Complete(const Handler& handler, const boost::system::error_code& ec, std::size_t transferred) noexcept {
+                /* Never complete inside the initiating call, the asio composed operations rely on it. */
+                Handler handler_ = handler;
+                boost::asio::post(socket_.get_executor(),
+                    [handler_, ec, transferred]() mutable noexcept {
+                        handler_(ec, transferred);
+                    });
+            }
+
+        private:
+            ::SSL*                                                          ssl_;
+            boost::asio::ip::tcp::socket&                                   socket_;
+        };
+    }
+}
\ No newline at end of file
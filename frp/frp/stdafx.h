@@ -54,6 +54,7 @@
 #include <set>
 #include <regex>
 #include <vector>
+#include <bitset>
 #include <fstream>
 #include <unordered_set>
 #include <unordered_map>
@@ -79,6 +80,11 @@
 #include <boost/asio/spawn.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 
+/* Websocket frame masking comes from frp/net/WebSocketMask.h instead of beast's bytewise loop. */
+#ifndef BOOST_BEAST_WEBSOCKET_DETAIL_MASK_IPP
+#define BOOST_BEAST_WEBSOCKET_DETAIL_MASK_IPP
+#endif
+
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/beast.hpp>
@@ -881,4 +887,6 @@ namespace network {
             }
         }
     }
-}
\ No newline at end of file
+}
+
+#include <frp/net/WebSocketMask.h>
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include <frp/threading/Hosting.h>
+#include <frp/threading/WorkerPool.h>
 
 namespace frp {
     namespace threading {
@@ -31,6 +32,25 @@ namespace frp {
             return true;
         }
 
+        bool Hosting::OpenWorkers(int concurrency) noexcept {
+            if (workers_) {
+                return true;
+            }
+
+            /* No workers asked for, the heavy lifting keeps running inline on the hosting loop. */
+            if (concurrency < 1) {
+                return false;
+            }
+
+            std::shared_ptr<WorkerPool> workers = NewReference<WorkerPool>(concurrency);
+            if (!workers || !workers->Open()) {
+                return false;
+            }
+
+            workers_ = std::move(workers);
+            return true;
+        }
+
         bool Hosting::OpenTimeout() noexcept {
             if (timeout_ || !context_) {
                 return true;
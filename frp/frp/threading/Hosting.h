@@ -4,6 +4,8 @@
 
 namespace frp {
     namespace threading {
+        class WorkerPool;
+
         class Hosting final : public Reference {
             typedef std::shared_ptr<boost::asio::io_context>            ContextPtr;
             typedef std::mutex                                          Mutex;
@@ -22,6 +24,10 @@ namespace frp {
             inline const std::shared_ptr<Byte>&                         GetBuffer() noexcept {
                 return buffer_;
             }
+            inline const std::shared_ptr<WorkerPool>&                   GetWorkers() noexcept {
+                return workers_;
+            }
+            bool                                                        OpenWorkers(int concurrency) noexcept;
             bool                                                        OpenTimeout() noexcept;
             bool                                                        Run(std::function<void()> entryPoint) noexcept;
 
@@ -101,6 +107,7 @@ namespace frp {
             std::shared_ptr<Byte>                                       buffer_;
             std::shared_ptr<boost::asio::io_context>                    context_;
             std::shared_ptr<boost::asio::deadline_timer>                timeout_;
+            std::shared_ptr<WorkerPool>                                 workers_;
         };
     }
 }
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include <frp/threading/WorkerPipeline.h>
+#include <frp/threading/WorkerPool.h>
+
+namespace frp {
+    namespace threading {
+        WorkerPipeline::WorkerPipeline(const std::shared_ptr<WorkerPool>& workers, const std::shared_ptr<boost::asio::io_context>& context, int lanes) noexcept
+            : disposed_(false)
+            , flushing_(false)
+            , lanes_(std::max<int>(1, lanes))
+            , workers_(workers)
+            , context_(context) {
+            for (int i = lanes_ - 1; i >= 0; i--) {
+                idles_.emplace_back(i);
+            }
+        }
+
+        bool WorkerPipeline::Post(const BOOST_ASIO_MOVE_ARG(WorkHandler) work, const BOOST_ASIO_MOVE_ARG(CompleteHandler) complete) noexcept {
+            if (disposed_ || !work || !complete || !workers_ || !context_) {
+                return false;
+            }
+
+            JobPtr job = make_shared_object<Job>();
+            if (!job) {
+                return false;
+            }
+
+            job->work = BOOST_ASIO_MOVE_CAST(WorkHandler)(constantof(work));
+            job->complete = BOOST_ASIO_MOVE_CAST(CompleteHandler)(constantof(complete));
+            job->lane = -1;
+            job->done = false;
+            job->success = false;
+
+            jobs_.emplace_back(job);
+            waits_.emplace_back(job);
+            Next();
+            Flush();
+            return true;
+        }
+
+        bool WorkerPipeline::Post(bool success, const BOOST_ASIO_MOVE_ARG(CompleteHandler) complete) noexcept {
+            if (disposed_ || !complete) {
+                return false;
+            }
+
+            JobPtr job = make_shared_object<Job>();
+            if (!job) {
+                return false;
+            }
+
+            /* Work that already happened on the loop (or an error), it still has to queue up behind whatever is in flight. */
+            job->complete = BOOST_ASIO_MOVE_CAST(CompleteHandler)(constantof(complete));
+            job->lane = -1;
+            job->done = true;
+            job->success = success;
+
+            jobs_.emplace_back(job);
+            Flush();
+            return true;
+        }
+
+        void WorkerPipeline::Next() noexcept {
+            while (!waits_.empty() && !idles_.empty()) {
+                JobPtr job = std::move(waits_.front());
+                waits_.pop_front();
+
+                job->lane = idles_.back();
+                idles_.pop_back();
+
+                /* Nothing but the job touches its lane until the result is back on the loop,
+                 * and the last reference must never be dropped on a worker, so it travels with the result.
+                 */
+                std::shared_ptr<Reference> reference = GetReference();
+                bool posted = workers_->Post(
+                    [reference, this, job]() mutable noexcept {
+                        bool success = job->work(job->lane);
+                        boost::asio::post(*context_, std::bind(
+                            [this, success](std::shared_ptr<Reference>& reference, JobPtr& job) noexcept {
+                                idles_.emplace_back(job->lane);
+                                job->work = NULL;
+                                job->success = success;
+                                job->done = true;
+                                if (!disposed_) {
+                                    Next();
+                                    Flush();
+                                }
+                            }, std::move(reference), std::move(job)));
+                    });
+                if (!posted) {
+                    job->done = true;
+                    idles_.emplace_back(job->lane);
+                }
+            }
+        }
+
+        void WorkerPipeline::Flush() noexcept {
+            /* A completion may well post again, the outer loop keeps the order. */
+            if (flushing_) {
+                return;
+            }
+
+            flushing_ = true;
+            while (!disposed_ && !jobs_.empty()) {
+                JobPtr job = jobs_.front();
+                if (!job->done) {
+                    break;
+                }
+
+                jobs_.pop_front();
+                CompleteHandler complete = std::move(job->complete);
+                job->complete = NULL;
+                complete(job->success);
+            }
+            flushing_ = false;
+        }
+
+        void WorkerPipeline::Dispose() noexcept {
+            /* Jobs still on a worker finish there and are dropped once back on the loop. */
+            disposed_ = true;
+            jobs_.clear();
+            waits_.clear();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <frp/Reference.h>
+
+namespace frp {
+    namespace threading {
+        class WorkerPool;
+
+        /* Fans work out to a WorkerPool and hands the results back to the loop in the order it was posted.
+         * Every job runs on a lane of its own, a lane is the index of some per job state (a cipher context say) nobody else touches meanwhile,
+         * so the number of lanes bounds how much work is in flight at once.
+         */
+        class WorkerPipeline final : public Reference {
+        public:
+            typedef std::function<bool(int)>                            WorkHandler;
+            typedef std::function<void(bool)>                           CompleteHandler;
+
+        public:
+            WorkerPipeline(const std::shared_ptr<WorkerPool>& workers, const std::shared_ptr<boost::asio::io_context>& context, int lanes) noexcept;
+
+        public:
+            inline int                                                  GetLanes() noexcept {
+                return lanes_;
+            }
+            inline int                                                  GetCount() noexcept {
+                return (int)jobs_.size();
+            }
+            inline bool                                                 IsIdle() noexcept {
+                return jobs_.empty();
+            }
+            bool                                                        Post(const BOOST_ASIO_MOVE_ARG(WorkHandler) work, const BOOST_ASIO_MOVE_ARG(CompleteHandler) complete) noexcept;
+            bool                                                        Post(bool success, const BOOST_ASIO_MOVE_ARG(CompleteHandler) complete) noexcept;
+            void                                                        Dispose() noexcept;
+
+        private:
+            typedef struct {
+                WorkHandler                                             work;
+                CompleteHandler                                         complete;
+                int                                                     lane;
+                bool                                                    done;
+                bool                                                    success;
+            }                                                           Job;
+            typedef std::shared_ptr<Job>                                JobPtr;
+
+        private:
+            void                                                        Next() noexcept;
+            void                                                        Flush() noexcept;
+
+        private:
+            bool                                                        disposed_;
+            bool                                                        flushing_;
+            int                                                         lanes_;
+            std::vector<int>                                            idles_;
+            std::list<JobPtr>                                           jobs_;
+            std::list<JobPtr>                                           waits_;
+            std::shared_ptr<WorkerPool>                                 workers_;
+            std::shared_ptr<boost::asio::io_context>                    context_;
+        };
+    }
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include <frp/threading/WorkerPool.h>
+#include <frp/threading/Hosting.h>
+
+namespace frp {
+    namespace threading {
+        WorkerPool::WorkerPool(int concurrency) noexcept
+            : concurrency_(concurrency) {
+            int max_concurrency = Hosting::GetMaxConcurrency();
+            if (concurrency_ < 1 || concurrency_ > max_concurrency) {
+                concurrency_ = max_concurrency;
+            }
+        }
+
+        WorkerPool::~WorkerPool() noexcept {
+            Close();
+        }
+
+        bool WorkerPool::Open() noexcept {
+            MutexScope scope_(lockobj_);
+            if (context_) {
+                return true;
+            }
+
+            std::shared_ptr<boost::asio::io_context> context = make_shared_object<boost::asio::io_context>(concurrency_);
+            if (!context) {
+                return false;
+            }
+
+            work_ = make_shared_object<boost::asio::io_context::work>(*context);
+            if (!work_) {
+                return false;
+            }
+
+            for (int i = 0; i < concurrency_; i++) {
+                ThreadPtr thread = make_shared_object<std::thread>(
+                    [context]() noexcept {
+                        boost::system::error_code ec_;
+                        context->run(ec_);
+                    });
+                if (!thread) {
+                    break;
+                }
+                threads_.emplace_back(thread);
+            }
+
+            /* Not a single thread came up, nobody would ever run the queued work. */
+            if (threads_.empty()) {
+                work_.reset();
+                return false;
+            }
+
+            context_ = context;
+            return true;
+        }
+
+        void WorkerPool::Close() noexcept {
+            ThreadArrayList threads;
+            std::shared_ptr<boost::asio::io_context> context; {
+                MutexScope scope_(lockobj_);
+                context = std::move(context_);
+                threads = std::move(threads_);
+                work_.reset();
+                context_.reset();
+                threads_.clear();
+            }
+
+            if (context) {
+                context->stop();
+            }
+
+            for (ThreadPtr& thread : threads) {
+                if (thread->joinable()) {
+                    if (thread->get_id() == std::this_thread::get_id()) {
+                        thread->detach();
+                    }
+                    else {
+                        thread->join();
+                    }
+                }
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <frp/Reference.h>
+
+namespace frp {
+    namespace threading {
+        /* A small, bounded set of threads for CPU heavy work (asymmetric crypto and the like) that must stay off the hosting loop.
+         * Work is queued in order and runs on at most GetConcurrency() threads at once, completions are posted back by the caller.
+         */
+        class WorkerPool final : public Reference {
+            typedef std::mutex                                          Mutex;
+            typedef std::lock_guard<Mutex>                              MutexScope;
+            typedef std::shared_ptr<std::thread>                        ThreadPtr;
+            typedef std::vector<ThreadPtr>                              ThreadArrayList;
+
+        public:
+            WorkerPool(int concurrency) noexcept;
+            ~WorkerPool() noexcept;
+
+        public:
+            inline int                                                  GetConcurrency() noexcept {
+                return concurrency_;
+            }
+            inline const std::shared_ptr<boost::asio::io_context>&      GetContext() noexcept {
+                return context_;
+            }
+            bool                                                        Open() noexcept;
+            void                                                        Close() noexcept;
+
+        public:
+            template<typename WorkHandler>
+            inline bool                                                 Post(const BOOST_ASIO_MOVE_ARG(WorkHandler) handler) noexcept {
+                const std::shared_ptr<boost::asio::io_context> context = context_;
+                if (!context) {
+                    return false;
+                }
+
+                boost::asio::post(*context, BOOST_ASIO_MOVE_CAST(WorkHandler)(constantof(handler)));
+                return true;
+            }
+
+        private:
+            int                                                         concurrency_;
+            Mutex                                                       lockobj_;
+            ThreadArrayList                                             threads_;
+            std::shared_ptr<boost::asio::io_context>                    context_;
+            std::shared_ptr<boost::asio::io_context::work>              work_;
+        };
+    }
+}
\ No newline at end of file
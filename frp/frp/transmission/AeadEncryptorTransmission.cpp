@@ -0,0 +1,79 @@
+#include <frp/transmission/AeadEncryptorTransmission.h>
+
+namespace frp {
+    namespace transmission {
+        typedef frp::cryptography::AeadEncryptor AeadEncryptor;
+
+        AeadEncryptorTransmission::AeadEncryptorTransmission(
+            const std::shared_ptr<frp::threading::Hosting>&             hosting, 
+            const std::shared_ptr<boost::asio::io_context>&             context, 
+            const std::shared_ptr<boost::asio::ip::tcp::socket>&        socket,
+            const std::string&                                          method,
+            const std::string&                                          password,
+            bool                                                        pipeline) noexcept 
+            : CipherTransmission(hosting, context, socket, pipeline) 
+            , method_(method)
+            , password_(password)
+            , initiator_(false)
+            , encryptor_(method, password) {
+            
+        }
+
+        bool AeadEncryptorTransmission::HandshakeAsync(HandshakeType type, const BOOST_ASIO_MOVE_ARG(HandshakeAsyncCallback) callback) noexcept {
+            /* The frp client initiates the transmission, both directions then count their own nonces. */
+            initiator_ = type == HandshakeType_Client;
+            encryptor_.SetInitiator(initiator_);
+            return CipherTransmission::HandshakeAsync(type, forward0f(callback));
+        }
+
+        bool AeadEncryptorTransmission::OpenLanes(int lanes) noexcept {
+            if (lanes_.size()) {
+                return true;
+            }
+
+            /* The nonce comes from the frame sequence, so any instance seals or opens any frame. */
+            for (int i = 0; i < lanes; i++) {
+                std::shared_ptr<AeadEncryptor> encryptor = make_shared_object<AeadEncryptor>(method_, password_);
+                if (!encryptor) {
+                    lanes_.clear();
+                    return false;
+                }
+
+                encryptor->SetInitiator(initiator_);
+                lanes_.emplace_back(encryptor);
+            }
+            return true;
+        }
+
+        AeadEncryptor& AeadEncryptorTransmission::GetEncryptor(int lane) noexcept {
+            if (lane < 0 || lane >= (int)lanes_.size()) {
+                return encryptor_;
+            }
+            return *lanes_[lane];
+        }
+
+        AeadEncryptorTransmission::pmessage AeadEncryptorTransmission::Seal(int lane, UInt64 sequence, const Byte* data, int length, const WriteAsyncCallback& callback) noexcept {
+            /* Copy the payload into the frame once and seal it there, the tag is appended behind it. */
+            pmessage messages = Pack(data, 0, length, AeadEncryptor::TAG_SIZE, forward0f(callback));
+            if (!messages) {
+                return NULL;
+            }
+
+            Byte* payload = messages->packet.get() + ETRANSMISSION_TSS;
+            if (!GetEncryptor(lane).Encrypt(sequence, payload, length, payload + length)) {
+                return NULL;
+            }
+            return messages;
+        }
+        
+        std::shared_ptr<Byte> AeadEncryptorTransmission::Open(int lane, UInt64 sequence, const std::shared_ptr<Byte>& buffer, int length, int& outlen) noexcept {
+            /* Frames are opened where they were received, a forged or reordered one fails authentication. */
+            outlen = length - AeadEncryptor::TAG_SIZE;
+            if (outlen < 1 || !GetEncryptor(lane).Decrypt(sequence, buffer.get(), outlen, buffer.get() + outlen)) {
+                outlen = 0;
+                return NULL;
+            }
+            return buffer;
+        }
+    }
+}
\ No newline at end of file
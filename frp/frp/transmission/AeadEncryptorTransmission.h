@@ -0,0 +1,37 @@
+#pragma once
+
+#include <frp/transmission/CipherTransmission.h>
+#include <frp/cryptography/AeadEncryptor.h>
+
+namespace frp {
+    namespace transmission {
+        class AeadEncryptorTransmission : public CipherTransmission {
+        public:
+            AeadEncryptorTransmission(
+                const std::shared_ptr<frp::threading::Hosting>&             hosting, 
+                const std::shared_ptr<boost::asio::io_context>&             context, 
+                const std::shared_ptr<boost::asio::ip::tcp::socket>&        socket,
+                const std::string&                                          method,
+                const std::string&                                          password,
+                bool                                                        pipeline) noexcept;
+
+        public:
+            virtual bool                                                    HandshakeAsync(HandshakeType type, const BOOST_ASIO_MOVE_ARG(HandshakeAsyncCallback) callback) noexcept override;
+
+        protected:
+            virtual bool                                                    OpenLanes(int lanes) noexcept override;
+            virtual pmessage                                                Seal(int lane, UInt64 sequence, const Byte* data, int length, const WriteAsyncCallback& callback) noexcept override;
+            virtual std::shared_ptr<Byte>                                   Open(int lane, UInt64 sequence, const std::shared_ptr<Byte>& buffer, int length, int& outlen) noexcept override;
+
+        private:
+            frp::cryptography::AeadEncryptor&                               GetEncryptor(int lane) noexcept;
+
+        private:
+            std::string                                                     method_;
+            std::string                                                     password_;
+            bool                                                            initiator_;
+            frp::cryptography::AeadEncryptor                                encryptor_;
+            std::vector<std::shared_ptr<frp::cryptography::AeadEncryptor> > lanes_;
+        };
+    }
+}
\ No newline at end of file
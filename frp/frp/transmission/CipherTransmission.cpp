@@ -0,0 +1,310 @@
+#include <frp/transmission/CipherTransmission.h>
+#include <frp/threading/WorkerPool.h>
+#include <frp/threading/WorkerPipeline.h>
+
+namespace frp {
+    namespace transmission {
+        CipherTransmission::CipherTransmission(
+            const std::shared_ptr<frp::threading::Hosting>&             hosting, 
+            const std::shared_ptr<boost::asio::io_context>&             context, 
+            const std::shared_ptr<boost::asio::ip::tcp::socket>&        socket,
+            bool                                                        pipeline) noexcept 
+            : Transmission(hosting, context, socket) 
+            , disposed_(false)
+            , pipeline_(pipeline)
+            , reading_(false)
+            , eof_(false)
+            , seal_sequence_(0)
+            , open_sequence_(0) {
+            
+        }
+
+        void CipherTransmission::Dispose() noexcept {
+            if (!disposed_.exchange(true)) {
+                std::shared_ptr<frp::threading::WorkerPipeline> seals = std::move(seals_);
+                if (seals) {
+                    seals_.reset();
+                    seals->Dispose();
+                }
+
+                std::shared_ptr<frp::threading::WorkerPipeline> opens = std::move(opens_);
+                if (opens) {
+                    opens_.reset();
+                    opens->Dispose();
+                }
+
+                /* Whoever waits on a frame opened ahead gets to know, as it would from the socket. */
+                frames_.clear();
+                ReadAsyncCallback callback = std::move(read_callback_);
+                read_callback_ = NULL;
+                if (callback) {
+                    const std::shared_ptr<ITransmission> reference_ = GetReference();
+                    boost::asio::post(*GetContext(),
+                        [reference_, callback]() noexcept {
+                            callback(NULL, -1);
+                        });
+                }
+                Transmission::Dispose();
+            }
+        }
+
+        bool CipherTransmission::HandshakeAsync(HandshakeType type, const BOOST_ASIO_MOVE_ARG(HandshakeAsyncCallback) callback) noexcept {
+            /* Both directions count frames from the start of the transmission. */
+            seal_sequence_ = 0;
+            open_sequence_ = 0;
+            if (pipeline_) {
+                OpenPipeline();
+            }
+            return Transmission::HandshakeAsync(type, forward0f(callback));
+        }
+
+        bool CipherTransmission::OpenPipeline() noexcept {
+            if (seals_ || opens_ || disposed_) {
+                return false;
+            }
+
+            /* Without workers the frames stay on the loop as they always did. */
+            const std::shared_ptr<frp::threading::WorkerPool>& workers = GetHosting()->GetWorkers();
+            if (!workers) {
+                return false;
+            }
+
+            /* Twice the lanes of the workers, so they have the next frames at hand while the loop flushes the last ones. */
+            int lanes = workers->GetConcurrency() << 1;
+            if (!OpenLanes(lanes)) {
+                return false;
+            }
+
+            seals_ = Reference::NewReference<frp::threading::WorkerPipeline>(workers, GetContext(), lanes);
+            opens_ = Reference::NewReference<frp::threading::WorkerPipeline>(workers, GetContext(), lanes);
+            if (!seals_ || !opens_) {
+                seals_.reset();
+                opens_.reset();
+                return false;
+            }
+            return true;
+        }
+
+        bool CipherTransmission::NextSequence(UInt64& counter, UInt64& sequence) noexcept {
+            sequence = counter++;
+            return counter != 0; /* Never reuse a nonce under the same key. */
+        }
+
+        bool CipherTransmission::WriteAsync(const std::shared_ptr<Byte>& buffer, int offset, int length, const BOOST_ASIO_MOVE_ARG(WriteAsyncCallback) callback) noexcept {
+            if (!buffer || offset < 0 || length < 1) {
+                return false;
+            }
+
+            if (!GetSocket()->is_open()) {
+                return false;
+            }
+
+            UInt64 sequence;
+            if (!NextSequence(seal_sequence_, sequence)) {
+                return false;
+            }
+
+            const std::shared_ptr<frp::threading::WorkerPipeline> seals = seals_;
+            if (!seals || (length < PIPELINE_FRAME_SIZE && seals->IsIdle())) {
+                pmessage messages = Seal(-1, sequence, buffer.get() + offset, length, callback);
+                if (!messages) {
+                    return false;
+                }
+
+                OnAddWriteAsync(forward0f(messages));
+                return true;
+            }
+
+            /* Whatever is sealed has to wait for the frames written before it. */
+            const std::shared_ptr<ITransmission> reference_ = GetReference();
+            if (length < PIPELINE_FRAME_SIZE) {
+                pmessage messages = Seal(-1, sequence, buffer.get() + offset, length, callback);
+                return seals->Post(NULL != messages,
+                    [reference_, this, messages](bool success) noexcept {
+                        if (success) {
+                            OnAddWriteAsync(forward0f(messages));
+                        }
+                        else {
+                            Close();
+                        }
+                    });
+            }
+
+            /* The caller may reuse its buffer as soon as this returns, the worker gets a copy. */
+            std::shared_ptr<Byte> data = make_shared_alloc<Byte>(length);
+            std::shared_ptr<pmessage> messages = make_shared_object<pmessage>();
+            if (!data || !messages) {
+                return false;
+            }
+
+            memcpy(data.get(), buffer.get() + offset, length);
+            const WriteAsyncCallback callback_ = BOOST_ASIO_MOVE_CAST(WriteAsyncCallback)(constantof(callback));
+            return seals->Post(
+                [reference_, this, sequence, data, length, messages, callback_](int lane) noexcept {
+                    *messages = Seal(lane, sequence, data.get(), length, callback_);
+                    return NULL != *messages;
+                },
+                [reference_, this, messages, callback_](bool success) noexcept {
+                    if (success) {
+                        OnAddWriteAsync(forward0f(*messages));
+                    }
+                    else {
+                        Close();
+                        if (callback_) {
+                            callback_(false);
+                        }
+                    }
+                });
+        }
+
+        bool CipherTransmission::ReadAsync(const BOOST_ASIO_MOVE_ARG(ReadAsyncCallback) callback) noexcept {
+            if (!callback) {
+                return false;
+            }
+
+            const ReadAsyncCallback callback_ = BOOST_ASIO_MOVE_CAST(ReadAsyncCallback)(constantof(callback));
+            if (!opens_) {
+                return Transmission::ReadAsync(
+                    [callback_, this](const std::shared_ptr<Byte>& buffer, int length) noexcept {
+                        if (!buffer || length < 1) {
+                            callback_(buffer, length);
+                            return;
+                        }
+
+                        /* A frame failing to open tears the transmission down. */
+                        int outlen = 0;
+                        UInt64 sequence;
+                        std::shared_ptr<Byte> packet = NextSequence(open_sequence_, sequence) ? Open(-1, sequence, buffer, length, outlen) : NULL;
+                        if (!packet || outlen < 1) {
+                            Close();
+                            callback_(NULL, -1);
+                        }
+                        else {
+                            callback_(packet, outlen);
+                        }
+                    });
+            }
+
+            if (read_callback_ || disposed_) {
+                return false;
+            }
+
+            read_callback_ = callback_;
+            Deliver();
+            ReadAheadAsync();
+            return true;
+        }
+
+        void CipherTransmission::ReadAheadAsync() noexcept {
+            const std::shared_ptr<frp::threading::WorkerPipeline> opens = opens_;
+            if (!opens || reading_ || eof_) {
+                return;
+            }
+
+            /* The lanes in flight plus the frames nobody asked for yet make up the read ahead window. */
+            if ((opens->GetCount() + (int)frames_.size()) >= opens->GetLanes()) {
+                return;
+            }
+
+            const std::shared_ptr<ITransmission> reference_ = GetReference();
+            reading_ = Transmission::ReadAsync(
+                [reference_, this](const std::shared_ptr<Byte>& buffer, int length) noexcept {
+                    reading_ = false;
+                    OnReadAhead(buffer, length);
+                });
+            if (!reading_) {
+                OnReadAhead(NULL, -1);
+            }
+        }
+
+        void CipherTransmission::OnReadAhead(const std::shared_ptr<Byte>& buffer, int length) noexcept {
+            const std::shared_ptr<frp::threading::WorkerPipeline> opens = opens_;
+            if (!opens) {
+                return;
+            }
+
+            const std::shared_ptr<ITransmission> reference_ = GetReference();
+            UInt64 sequence;
+            if (!buffer || length < 1 || !NextSequence(open_sequence_, sequence)) {
+                eof_ = true;
+                opens->Post(false,
+                    [reference_, this, length](bool success) noexcept {
+                        AddFrame(NULL, std::min<int>(0, length));
+                    });
+                return;
+            }
+
+            /* The receive buffer is reused by the next read right away. */
+            std::shared_ptr<Byte> data = make_shared_alloc<Byte>(length);
+            std::shared_ptr<frame> frames = make_shared_object<frame>();
+            if (!data || !frames) {
+                eof_ = true;
+                opens->Post(false,
+                    [reference_, this](bool success) noexcept {
+                        Close();
+                        AddFrame(NULL, -1);
+                    });
+                return;
+            }
+
+            memcpy(data.get(), buffer.get(), length);
+            frames->length = 0;
+
+            const auto complete = [reference_, this, frames](bool success) noexcept {
+                if (!success || !frames->buffer || frames->length < 1) {
+                    eof_ = true;
+                    Close();
+                    AddFrame(NULL, -1);
+                }
+                else {
+                    AddFrame(frames->buffer, frames->length);
+                }
+            };
+
+            if (length < PIPELINE_FRAME_SIZE) {
+                frames->buffer = Open(-1, sequence, data, length, frames->length);
+                opens->Post(NULL != frames->buffer, complete);
+            }
+            else {
+                opens->Post(
+                    [reference_, this, sequence, data, length, frames](int lane) noexcept {
+                        frames->buffer = Open(lane, sequence, data, length, frames->length);
+                        return NULL != frames->buffer;
+                    }, complete);
+            }
+
+            ReadAheadAsync();
+        }
+
+        void CipherTransmission::AddFrame(const std::shared_ptr<Byte>& buffer, int length) noexcept {
+            frame frame_;
+            frame_.buffer = buffer;
+            frame_.length = length;
+            frames_.emplace_back(frame_);
+
+            Deliver();
+            ReadAheadAsync();
+        }
+
+        void CipherTransmission::Deliver() noexcept {
+            if (!read_callback_ || frames_.empty()) {
+                return;
+            }
+
+            /* The end of the stream (or an error) stays queued, every later read gets it as well. */
+            frame frame_ = frames_.front();
+            if (frame_.length > 0) {
+                frames_.pop_front();
+            }
+
+            ReadAsyncCallback callback = std::move(read_callback_);
+            read_callback_ = NULL;
+
+            const std::shared_ptr<ITransmission> reference_ = GetReference();
+            boost::asio::post(*GetContext(),
+                [reference_, callback, frame_]() noexcept {
+                    callback(frame_.buffer, frame_.length);
+                });
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <frp/transmission/Transmission.h>
+
+namespace frp {
+    namespace threading {
+        class WorkerPipeline;
+    }
+
+    namespace transmission {
+        /* Common ground of the encryptor transmissions: every frame is sealed and opened by the derived cipher under a frame sequence number.
+         * With the pipeline turned on (and hosting workers open) large frames are handed to the workers, each on a lane (cipher instance) of its own,
+         * the sealed frames are queued for the socket in the order they were written, and the read side keeps opening frames ahead of the caller.
+         */
+        class CipherTransmission : public Transmission {
+        public:
+            CipherTransmission(
+                const std::shared_ptr<frp::threading::Hosting>&             hosting, 
+                const std::shared_ptr<boost::asio::io_context>&             context, 
+                const std::shared_ptr<boost::asio::ip::tcp::socket>&        socket,
+                bool                                                        pipeline) noexcept;
+
+        public:
+            virtual void                                                    Dispose() noexcept override;
+            virtual bool                                                    HandshakeAsync(HandshakeType type, const BOOST_ASIO_MOVE_ARG(HandshakeAsyncCallback) callback) noexcept override;
+            virtual bool                                                    WriteAsync(const std::shared_ptr<Byte>& buffer, int offset, int length, const BOOST_ASIO_MOVE_ARG(WriteAsyncCallback) callback) noexcept override;
+            virtual bool                                                    ReadAsync(const BOOST_ASIO_MOVE_ARG(ReadAsyncCallback) callback) noexcept override;
+
+        protected:
+            /* Frames below this are cheaper to seal on the loop than to hand over. */
+            static const int                                                PIPELINE_FRAME_SIZE = 4096;
+
+        protected:
+            /* Lane -1 is the cipher of the loop, the others are only ever used by one worker at a time. */
+            virtual bool                                                    OpenLanes(int lanes) noexcept = 0;
+            virtual pmessage                                                Seal(int lane, UInt64 sequence, const Byte* data, int length, const WriteAsyncCallback& callback) noexcept = 0;
+            virtual std::shared_ptr<Byte>                                   Open(int lane, UInt64 sequence, const std::shared_ptr<Byte>& buffer, int length, int& outlen) noexcept = 0;
+
+        private:
+            bool                                                            OpenPipeline() noexcept;
+            bool                                                            NextSequence(UInt64& counter, UInt64& sequence) noexcept;
+            void                                                            ReadAheadAsync() noexcept;
+            void                                                            OnReadAhead(const std::shared_ptr<Byte>& buffer, int length) noexcept;
+            void                                                            AddFrame(const std::shared_ptr<Byte>& buffer, int length) noexcept;
+            void                                                            Deliver() noexcept;
+
+        private:
+            typedef struct {
+                std::shared_ptr<Byte>                                       buffer;
+                int                                                         length;
+            }                                                               frame;
+            typedef std::list<frame>                                        frame_queue;
+
+        private:
+            std::atomic<bool>                                               disposed_;
+            bool                                                            pipeline_;
+            bool                                                            reading_;
+            bool                                                            eof_;
+            UInt64                                                          seal_sequence_;
+            UInt64                                                          open_sequence_;
+            std::shared_ptr<frp::threading::WorkerPipeline>                 seals_;
+            std::shared_ptr<frp::threading::WorkerPipeline>                 opens_;
+            ReadAsyncCallback                                               read_callback_;
+            frame_queue                                                     frames_;
+        };
+    }
+}
\ No newline at end of file
@@ -0,0 +1,287 @@
+#include <frp/transmission/CompressionTransmission.h>
+#include <frp/messages/PacketCommands.h>
+#include <frp/threading/Hosting.h>
+
+namespace frp {
+    namespace transmission {
+        /* Packets too small to be worth the flush marker. */
+        static const int COMPRESSIONTRANSMISSION_MIN_PACKET  = 128;
+        /* A stream is judged once this much of it went through the deflater. */
+        static const int COMPRESSIONTRANSMISSION_SAMPLE_SIZE = 64 * 1024;
+        /* A stream that did not shrink by an eighth is passed through for this long before it is sampled again. */
+        static const int COMPRESSIONTRANSMISSION_SKIP_SIZE   = 1024 * 1024;
+        /* Datagrams carry no connection id, they are all sampled as one stream. */
+        static const int COMPRESSIONTRANSMISSION_DATAGRAM    = -1;
+        /* deflateBound leaves out the empty stored block a sync flush appends. */
+        static const int COMPRESSIONTRANSMISSION_FLUSH_SLACK = 16;
+
+        CompressionTransmission::CompressionTransmission(const std::shared_ptr<ITransmission>& transmission) noexcept
+            : disposed_(false)
+            , compressing_(false)
+            , transmission_(transmission) {
+            /* Speed over ratio, a raw deflate stream (no zlib header) with the default window. */
+            deflater_.reset(1, 15, 8, boost::beast::zlib::Strategy::normal);
+            inflater_.reset(15);
+            buffer_ = make_shared_alloc<Byte>(frp::threading::Hosting::BufferSize);
+        }
+
+        void CompressionTransmission::Dispose() noexcept {
+            if (!disposed_.exchange(true)) {
+                samples_.clear();
+                transmission_->Close();
+            }
+        }
+
+        bool CompressionTransmission::AcknowledgeAsync() noexcept {
+            if (compressing_) {
+                return false;
+            }
+
+            /* An empty deflate frame tells frpc it may compress as well, nothing else is sent before it. */
+            std::shared_ptr<Byte> packet = make_shared_alloc<Byte>(1);
+            if (!packet) {
+                return false;
+            }
+
+            *packet = (Byte)frp::messages::PacketCommands_Deflate;
+            compressing_ = transmission_->WriteAsync(packet, 0, 1, NULL);
+            return compressing_;
+        }
+
+        bool CompressionTransmission::HandshakeAsync(HandshakeType type, const BOOST_ASIO_MOVE_ARG(HandshakeAsyncCallback) callback) noexcept {
+            return transmission_->HandshakeAsync(type, forward0f(callback));
+        }
+
+        bool CompressionTransmission::SetEarlyData(const std::shared_ptr<Byte>& buffer, int offset, int length) noexcept {
+            return transmission_->SetEarlyData(buffer, offset, length);
+        }
+
+        std::shared_ptr<boost::asio::io_context> CompressionTransmission::GetContext() noexcept {
+            return transmission_->GetContext();
+        }
+
+        frp::net::IPEndPoint CompressionTransmission::GetLocalEndPoint() noexcept {
+            return transmission_->GetLocalEndPoint();
+        }
+
+        frp::net::IPEndPoint CompressionTransmission::GetRemoteEndPoint() noexcept {
+            return transmission_->GetRemoteEndPoint();
+        }
+
+        bool CompressionTransmission::WriteAsync(const std::shared_ptr<Byte>& buffer, int offset, int length, const BOOST_ASIO_MOVE_ARG(WriteAsyncCallback) callback) noexcept {
+            if (!buffer || offset < 0 || length < 1) {
+                return false;
+            }
+
+            int stream;
+            const Byte* packet = buffer.get() + offset;
+            if (!ShouldCompress(packet, length, stream)) {
+                Forget(packet, length);
+                return transmission_->WriteAsync(buffer, offset, length, forward0f(callback));
+            }
+
+            int frame_size = 1 + (int)deflater_.upper_bound(length) + COMPRESSIONTRANSMISSION_FLUSH_SLACK;
+            std::shared_ptr<Byte> frame = make_shared_alloc<Byte>(frame_size);
+            if (!frame) {
+                return false;
+            }
+
+            boost::beast::zlib::z_params zs;
+            zs.next_in = packet;
+            zs.avail_in = length;
+            zs.next_out = frame.get() + 1;
+            zs.avail_out = frame_size - 1;
+
+            /* Once fed the deflater is ahead of the peer, the frame has to go out whatever the ratio. */
+            boost::system::error_code ec;
+            deflater_.write(zs, boost::beast::zlib::Flush::sync, ec);
+            if (ec || zs.avail_in != 0 || zs.avail_out == 0) {
+                Close();
+                return false;
+            }
+
+            int outlen = 1 + (int)zs.total_out;
+            *frame = (Byte)frp::messages::PacketCommands_Deflate;
+
+            Sample(stream, length, outlen);
+            return transmission_->WriteAsync(frame, 0, outlen, forward0f(callback));
+        }
+
+        bool CompressionTransmission::ReadAsync(const BOOST_ASIO_MOVE_ARG(ReadAsyncCallback) callback) noexcept {
+            if (!callback) {
+                return false;
+            }
+
+            const std::shared_ptr<ITransmission> reference_ = GetReference();
+            const ReadAsyncCallback callback_ = BOOST_ASIO_MOVE_CAST(ReadAsyncCallback)(constantof(callback));
+            return transmission_->ReadAsync(
+                [reference_, this, callback_](const std::shared_ptr<Byte>& buffer, int length) noexcept {
+                    if (!buffer || length < 1) {
+                        callback_(buffer, length);
+                        return;
+                    }
+
+                    const Byte* packet = buffer.get();
+                    if (*packet != (Byte)frp::messages::PacketCommands_Deflate) {
+                        Forget(packet, length);
+                        callback_(buffer, length);
+                        return;
+                    }
+
+                    /* frps acknowledged the feature, the packet the caller waits for is the next one. */
+                    if (length == 1) {
+                        compressing_ = true;
+                        if (!ReadAsync(forward0f(callback_))) {
+                            callback_(NULL, -1);
+                        }
+                        return;
+                    }
+
+                    int outlen;
+                    std::shared_ptr<Byte> output = Inflate(packet + 1, length - 1, outlen);
+                    if (!output) {
+                        Close();
+                        callback_(NULL, -1);
+                    }
+                    else {
+                        Forget(output.get(), outlen);
+                        callback_(output, outlen);
+                    }
+                });
+        }
+
+        std::shared_ptr<Byte> CompressionTransmission::Inflate(const Byte* packet, int length, int& outlen) noexcept {
+            outlen = 0;
+            if (!buffer_) {
+                return NULL;
+            }
+
+            boost::beast::zlib::z_params zs;
+            zs.next_in = packet;
+            zs.avail_in = length;
+            zs.next_out = buffer_.get();
+            zs.avail_out = frp::threading::Hosting::BufferSize;
+
+            /* Every frame ends on a flush marker, so all of it inflates at once, a packet never outgrows the receive buffer. */
+            boost::system::error_code ec;
+            inflater_.write(zs, boost::beast::zlib::Flush::sync, ec);
+            if (ec || zs.avail_in != 0 || zs.total_out < 1) {
+                return NULL;
+            }
+
+            outlen = (int)zs.total_out;
+            return buffer_;
+        }
+
+        bool CompressionTransmission::ShouldCompress(const Byte* packet, int length, int& stream) noexcept {
+            typedef frp::messages::PacketCommands PacketCommands;
+
+            stream = COMPRESSIONTRANSMISSION_DATAGRAM;
+            if (!compressing_ || length < COMPRESSIONTRANSMISSION_MIN_PACKET) {
+                return false;
+            }
+
+            /* Packets past this could outgrow the frame once deflated. */
+            if (1 + (int)deflater_.upper_bound(length) + COMPRESSIONTRANSMISSION_FLUSH_SLACK > frp::threading::Hosting::BufferSize) {
+                return false;
+            }
+
+            int header;
+            PacketCommands command = (PacketCommands)packet[0];
+            if (command == PacketCommands::PacketCommands_Write) {
+                header = 5;
+                stream = packet[1] << 24 | packet[2] << 16 | packet[3] << 8 | packet[4];
+            }
+            elif(command == PacketCommands::PacketCommands_WriteTo) {
+                header = 1;
+            }
+            else {
+                return false;
+            }
+
+            stream_sample_table::iterator tail = samples_.find(stream);
+            if (tail == samples_.end()) {
+                stream_sample sample;
+                sample.incompressible = command == PacketCommands::PacketCommands_Write && IsCompressed(packet + header, length - header);
+                sample.skip = 0;
+                sample.in = 0;
+                sample.out = 0;
+                tail = samples_.emplace(stream, sample).first;
+            }
+
+            stream_sample& sample = tail->second;
+            if (sample.incompressible) {
+                return false;
+            }
+
+            if (sample.skip > 0) {
+                sample.skip -= length;
+                return false;
+            }
+            return true;
+        }
+
+        void CompressionTransmission::Sample(int stream, int in, int out) noexcept {
+            stream_sample_table::iterator tail = samples_.find(stream);
+            if (tail == samples_.end()) {
+                return;
+            }
+
+            stream_sample& sample = tail->second;
+            sample.in += in;
+            sample.out += out;
+            if (sample.in >= COMPRESSIONTRANSMISSION_SAMPLE_SIZE) {
+                if (sample.out > (sample.in - (sample.in >> 3))) {
+                    sample.skip = COMPRESSIONTRANSMISSION_SKIP_SIZE;
+                }
+                sample.in = 0;
+                sample.out = 0;
+            }
+        }
+
+        void CompressionTransmission::Forget(const Byte* packet, int length) noexcept {
+            /* Connection ids are handed out again, so whatever was learnt about one ends with it. */
+            if (length >= 5 && packet[0] == (Byte)frp::messages::PacketCommands_Disconnect) {
+                int stream = packet[1] << 24 | packet[2] << 16 | packet[3] << 8 | packet[4];
+                samples_.erase(stream);
+            }
+        }
+
+        bool CompressionTransmission::IsIncompressible(const Byte* packet, int length) noexcept {
+            /* Only the data packets carry anything of size, and of those only stream payloads have a recognizable head. */
+            if (length < 5 || packet[0] != (Byte)frp::messages::PacketCommands_Write) {
+                return false;
+            }
+            return IsCompressed(packet + 5, length - 5);
+        }
+
+        bool CompressionTransmission::IsCompressed(const Byte* payload, int length) noexcept {
+            if (length < 4) {
+                return false;
+            }
+
+            /* TLS records (handshake, application data). */
+            if ((payload[0] == 0x16 || payload[0] == 0x17) && payload[1] == 0x03 && payload[2] <= 0x04) {
+                return true;
+            }
+
+            /* gzip, zip, 7z, xz, zstd. */
+            if ((payload[0] == 0x1f && payload[1] == 0x8b) ||
+                (payload[0] == 'P' && payload[1] == 'K' && payload[2] == 0x03 && payload[3] == 0x04) ||
+                (payload[0] == '7' && payload[1] == 'z' && payload[2] == 0xbc && payload[3] == 0xaf) ||
+                (payload[0] == 0xfd && payload[1] == '7' && payload[2] == 'z' && payload[3] == 'X') ||
+                (payload[0] == 0x28 && payload[1] == 0xb5 && payload[2] == 0x2f && payload[3] == 0xfd)) {
+                return true;
+            }
+
+            /* JPEG, PNG, GIF, WebP (RIFF), MP4 (ftyp). */
+            if ((payload[0] == 0xff && payload[1] == 0xd8 && payload[2] == 0xff) ||
+                (payload[0] == 0x89 && payload[1] == 'P' && payload[2] == 'N' && payload[3] == 'G') ||
+                (payload[0] == 'G' && payload[1] == 'I' && payload[2] == 'F' && payload[3] == '8') ||
+                (payload[0] == 'R' && payload[1] == 'I' && payload[2] == 'F' && payload[3] == 'F')) {
+                return true;
+            }
+            return length >= 8 && payload[4] == 'f' && payload[5] == 't' && payload[6] == 'y' && payload[7] == 'p';
+        }
+    }
+}
\ No newline at end of file
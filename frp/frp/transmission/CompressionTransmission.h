@@ -0,0 +1,60 @@
+#pragma once
+
+#include <frp/transmission/ITransmission.h>
+
+namespace frp {
+    namespace transmission {
+        /* Deflates the packets of another transmission, once both ends agreed on it in the handshake request.
+         * The data packets of a stream are sampled as they go, streams that do not shrink (TLS, media, archives) are passed through as they are,
+         * a compressed frame is a PacketCommands_Deflate command byte followed by the deflated packet, flushed (Z_SYNC_FLUSH) at every frame.
+         */
+        class CompressionTransmission : public ITransmission {
+        public:
+            CompressionTransmission(const std::shared_ptr<ITransmission>& transmission) noexcept;
+
+        public:
+            inline const std::shared_ptr<ITransmission>&                    GetTransmission() noexcept {
+                return transmission_;
+            }
+            bool                                                            AcknowledgeAsync() noexcept;
+            virtual void                                                    Dispose() noexcept override;
+            virtual bool                                                    HandshakeAsync(HandshakeType type, const BOOST_ASIO_MOVE_ARG(HandshakeAsyncCallback) callback) noexcept override;
+            virtual bool                                                    ReadAsync(const BOOST_ASIO_MOVE_ARG(ReadAsyncCallback) callback) noexcept override;
+            virtual bool                                                    WriteAsync(const std::shared_ptr<Byte>& buffer, int offset, int length, const BOOST_ASIO_MOVE_ARG(WriteAsyncCallback) callback) noexcept override;
+            virtual bool                                                    SetEarlyData(const std::shared_ptr<Byte>& buffer, int offset, int length) noexcept override;
+
+        public:
+            virtual std::shared_ptr<boost::asio::io_context>                GetContext() noexcept override;
+            virtual frp::net::IPEndPoint                                    GetLocalEndPoint() noexcept override;
+            virtual frp::net::IPEndPoint                                    GetRemoteEndPoint() noexcept override;
+
+        public:
+            static bool                                                     IsIncompressible(const Byte* packet, int length) noexcept;
+
+        private:
+            typedef struct {
+                bool                                                        incompressible;
+                int                                                         skip;
+                int                                                         in;
+                int                                                         out;
+            }                                                               stream_sample;
+            typedef std::unordered_map<int, stream_sample>                  stream_sample_table;
+
+        private:
+            bool                                                            ShouldCompress(const Byte* packet, int length, int& stream) noexcept;
+            void                                                            Sample(int stream, int in, int out) noexcept;
+            void                                                            Forget(const Byte* packet, int length) noexcept;
+            std::shared_ptr<Byte>                                           Inflate(const Byte* packet, int length, int& outlen) noexcept;
+            static bool                                                     IsCompressed(const Byte* payload, int length) noexcept;
+
+        private:
+            std::atomic<bool>                                               disposed_;
+            bool                                                            compressing_;
+            std::shared_ptr<ITransmission>                                  transmission_;
+            std::shared_ptr<Byte>                                           buffer_;
+            boost::beast::zlib::deflate_stream                              deflater_;
+            boost::beast::zlib::inflate_stream                              inflater_;
+            stream_sample_table                                             samples_;
+        };
+    }
+}
\ No newline at end of file
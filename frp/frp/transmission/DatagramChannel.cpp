@@ -0,0 +1,313 @@
+#include <frp/transmission/DatagramChannel.h>
+#include <frp/transmission/ForwardErrorCorrection.h>
+#include <frp/cryptography/AeadEncryptor.h>
+#include <frp/messages/Packet.h>
+#include <frp/threading/Timer.h>
+
+namespace frp {
+    namespace transmission {
+        static const char*  DATAGRAMCHANNEL_METHOD          = "aes-128-gcm";
+        static const int    DATAGRAMCHANNEL_PROBE           = 1000;
+        static const int    DATAGRAMCHANNEL_KEEPALIVE       = 10000;
+        static const int    DATAGRAMCHANNEL_TIMEOUT         = 30000;
+        static const int    DATAGRAMCHANNEL_REPLAY_WINDOW   = 64;
+
+        DatagramChannel::DatagramChannel(
+            const std::shared_ptr<frp::threading::Hosting>&             hosting,
+            const std::shared_ptr<boost::asio::ip::udp::socket>&        socket,
+            UInt32                                                      session,
+            const std::string&                                          secret,
+            bool                                                        initiator,
+            const frp::configuration::ForwardErrorCorrectionConfiguration& fec) noexcept
+            : disposed_(false)
+            , initiator_(initiator)
+            , session_(session)
+            , sequence_(0)
+            , replay_top_(0)
+            , replay_mask_(0)
+            , last_(0)
+            , loss_(std::max<int>(0, std::min<int>(100, fec.Loss)))
+            , fec_interval_(std::max<int>(1, fec.Timeout))
+            , hosting_(hosting)
+            , socket_(socket)
+            , buffer_(make_shared_alloc<Byte>(frp::threading::Hosting::BufferSize))
+            , fec_(make_shared_object<ForwardErrorCorrection>(fec.Data, fec.Parity)) {
+            encryptor_ = make_shared_object<frp::cryptography::AeadEncryptor>(DATAGRAMCHANNEL_METHOD, secret);
+            if (encryptor_) {
+                encryptor_->SetInitiator(initiator);
+            }
+        }
+
+        std::string DatagramChannel::NewSecret() noexcept {
+            Byte secret[SECRET_SIZE];
+            if (RAND_bytes(secret, sizeof(secret)) < 1) {
+                return std::string();
+            }
+            return std::string((char*)secret, sizeof(secret));
+        }
+
+        UInt32 DatagramChannel::GetSession(const Byte* buffer, int length) noexcept {
+            if (NULL == buffer || length <= OVERHEAD) {
+                return 0;
+            }
+            return (UInt32)buffer[0] << 24 | (UInt32)buffer[1] << 16 | (UInt32)buffer[2] << 8 | buffer[3];
+        }
+
+        bool DatagramChannel::Open(const boost::asio::ip::udp::endpoint& remoteEP, const BOOST_ASIO_MOVE_ARG(PacketInputCallback) callback) noexcept {
+            if (disposed_ || !encryptor_ || !buffer_ || !fec_ || !socket_ || !socket_->is_open()) {
+                return false;
+            }
+
+            callback_ = BOOST_ASIO_MOVE_CAST(PacketInputCallback)(constantof(callback));
+            if (!initiator_) {
+                return true; /* frps learns the address from the first datagram, the receiving is up to whoever owns the socket. */
+            }
+
+            remoteEP_ = remoteEP;
+            receive_buffer_ = make_shared_alloc<Byte>(frp::threading::Hosting::BufferSize);
+            if (!receive_buffer_) {
+                return false;
+            }
+            return ReceiveAsync() && Probe();
+        }
+
+        void DatagramChannel::Close() noexcept {
+            if (!disposed_.exchange(true)) {
+                callback_ = NULL;
+                frp::threading::ClearTimeout(timeout_);
+                frp::threading::ClearTimeout(fec_timeout_);
+                if (initiator_) {
+                    boost::system::error_code ec;
+                    socket_->close(ec);
+                }
+            }
+        }
+
+        void DatagramChannel::Dispose() noexcept {
+            Close();
+        }
+
+        bool DatagramChannel::IsAvailable() noexcept {
+            if (disposed_ || last_ == 0) {
+                return false;
+            }
+
+            UInt64 now = hosting_->CurrentMillisec();
+            return now >= last_ && now - last_ < (UInt64)DATAGRAMCHANNEL_TIMEOUT;
+        }
+
+        bool DatagramChannel::Probe() noexcept {
+            frp::threading::ClearTimeout(timeout_);
+            if (disposed_) {
+                return false;
+            }
+
+            frp::messages::Packet packet;
+            packet.Command = frp::messages::PacketCommands::PacketCommands_Heartbeat;
+            packet.Id = 0;
+            packet.Offset = 0;
+            packet.Length = 0;
+            SendTo(packet);
+
+            /* Quickly while nobody answers, afterwards just often enough to keep the NAT binding. */
+            const std::shared_ptr<Reference> reference = GetReference();
+            timeout_ = frp::threading::SetTimeout(hosting_,
+                [reference, this](void*) noexcept {
+                    Probe();
+                }, IsAvailable() ? DATAGRAMCHANNEL_KEEPALIVE : DATAGRAMCHANNEL_PROBE);
+            return NULL != timeout_;
+        }
+
+        bool DatagramChannel::ReceiveAsync() noexcept {
+            if (disposed_ || !socket_->is_open()) {
+                return false;
+            }
+
+            const std::shared_ptr<Reference> reference = GetReference();
+            socket_->async_receive_from(boost::asio::buffer(receive_buffer_.get(), frp::threading::Hosting::BufferSize), endpoint_,
+                [reference, this](const boost::system::error_code& ec, std::size_t sz) noexcept {
+                    if (ec == boost::system::errc::operation_canceled || disposed_) {
+                        return;
+                    }
+
+                    /* An ICMP unreachable while frps is not listening yet shows up here, probing goes on. */
+                    if (!ec) {
+                        Input(receive_buffer_.get(), (int)sz, endpoint_);
+                    }
+                    ReceiveAsync();
+                });
+            return true;
+        }
+
+        bool DatagramChannel::Replayed(UInt64 sequence) noexcept {
+            if (sequence > replay_top_) {
+                UInt64 shift = sequence - replay_top_;
+                replay_mask_ = shift >= DATAGRAMCHANNEL_REPLAY_WINDOW ? 0 : replay_mask_ << shift;
+                replay_mask_ |= 1;
+                replay_top_ = sequence;
+                return false;
+            }
+
+            UInt64 offset = replay_top_ - sequence;
+            if (offset >= DATAGRAMCHANNEL_REPLAY_WINDOW) {
+                return true;
+            }
+
+            UInt64 bit = (UInt64)1 << offset;
+            if (replay_mask_ & bit) {
+                return true;
+            }
+
+            replay_mask_ |= bit;
+            return false;
+        }
+
+        bool DatagramChannel::Input(Byte* buffer, int length, const boost::asio::ip::udp::endpoint& remoteEP) noexcept {
+            if (disposed_ || GetSession(buffer, length) != session_) {
+                return false;
+            }
+
+            UInt64 sequence = 0;
+            for (int i = 4; i < 12; i++) {
+                sequence = sequence << 8 | buffer[i];
+            }
+
+            /* Only what opens under the key counts, and only once, before it may move the address or the clock. */
+            if (!encryptor_->Decrypt(sequence, buffer + OVERHEAD, length - OVERHEAD, buffer + 12) || Replayed(sequence)) {
+                return false;
+            }
+
+            if (initiator_) {
+                if (remoteEP != remoteEP_) {
+                    return false;
+                }
+            }
+            else {
+                remoteEP_ = remoteEP; /* frpc may sit behind a NAT that rebinds. */
+            }
+
+            last_ = hosting_->CurrentMillisec();
+            if (buffer[OVERHEAD] == frp::messages::PacketCommands::PacketCommands_Fec) {
+                return fec_->Decode(buffer + OVERHEAD, length - OVERHEAD,
+                    [this](Byte* shard, int shard_size) noexcept {
+                        Output(shard, shard_size);
+                    });
+            }
+            return Output(buffer + OVERHEAD, length - OVERHEAD);
+        }
+
+        bool DatagramChannel::Output(Byte* buffer, int length) noexcept {
+            std::shared_ptr<frp::messages::Packet> packet = frp::messages::Packet::Deserialize(buffer, length);
+            if (!packet) {
+                return false;
+            }
+
+            if (packet->Command == frp::messages::PacketCommands::PacketCommands_Heartbeat) {
+                return initiator_ || SendTo(*packet);
+            }
+
+            PacketInputCallback callback = callback_;
+            if (callback) {
+                callback(packet);
+            }
+            return true;
+        }
+
+        bool DatagramChannel::WriteTo(const void* buffer, int length, const boost::asio::ip::udp::endpoint& endpoint) noexcept {
+            if (!IsAvailable()) {
+                return false;
+            }
+
+            /* Packed right behind the header, sealed in place and sent, no allocation on the way. */
+            Byte* frame = buffer_.get() + OVERHEAD;
+            if (!fec_->IsEncoder()) {
+                int packet_size = frp::messages::Packet::PackWriteTo(frame, frp::threading::Hosting::BufferSize - OVERHEAD, buffer, 0, length, endpoint);
+                if (packet_size < 1) {
+                    return false;
+                }
+                return SendTo(packet_size);
+            }
+
+            int packet_size = frp::messages::Packet::PackWriteTo(frame + ForwardErrorCorrection::HEADER_SIZE,
+                frp::threading::Hosting::BufferSize - OVERHEAD - ForwardErrorCorrection::HEADER_SIZE, buffer, 0, length, endpoint);
+            if (packet_size < 1) {
+                return false;
+            }
+
+            packet_size = fec_->Encode(frame, packet_size);
+            if (packet_size < 1) {
+                return false;
+            }
+
+            bool success = SendTo(packet_size);
+            if (fec_->IsFull()) {
+                FlushParity();
+            }
+            elif(fec_->GetCount() == 1) {
+                /* A group that does not fill up in time is closed with what it has, real time traffic cannot wait for the rest. */
+                const std::shared_ptr<Reference> reference = GetReference();
+                fec_timeout_ = frp::threading::SetTimeout(hosting_,
+                    [reference, this](void*) noexcept {
+                        fec_timeout_.reset();
+                        if (!disposed_) {
+                            FlushParity();
+                        }
+                    }, fec_interval_);
+            }
+            return success;
+        }
+
+        void DatagramChannel::FlushParity() noexcept {
+            frp::threading::ClearTimeout(fec_timeout_);
+            for (int i = 0, parity = fec_->GetParity(); i < parity; i++) {
+                int packet_size = fec_->Parity(i, buffer_.get() + OVERHEAD, frp::threading::Hosting::BufferSize - OVERHEAD);
+                if (packet_size > 0) {
+                    SendTo(packet_size);
+                }
+            }
+            fec_->NextGroup();
+        }
+
+        bool DatagramChannel::SendTo(frp::messages::Packet& packet) noexcept {
+            int packet_size = packet.Serialize(buffer_.get() + OVERHEAD, frp::threading::Hosting::BufferSize - OVERHEAD);
+            if (packet_size < 1) {
+                return false;
+            }
+            return SendTo(packet_size);
+        }
+
+        bool DatagramChannel::SendTo(int length) noexcept {
+            if (disposed_ || remoteEP_.port() == 0) {
+                return false;
+            }
+
+            UInt64 sequence = ++sequence_;
+            if (sequence == 0) {
+                return false;
+            }
+
+            Byte* p = buffer_.get();
+            p[0] = (Byte)(session_ >> 24);
+            p[1] = (Byte)(session_ >> 16);
+            p[2] = (Byte)(session_ >> 8);
+            p[3] = (Byte)(session_);
+            for (int i = 11; i >= 4; i--) {
+                p[i] = (Byte)sequence;
+                sequence >>= 8;
+            }
+
+            if (!encryptor_->Encrypt(sequence_, p + OVERHEAD, length, p + 12)) {
+                return false;
+            }
+
+            /* Dropped on purpose, the receiver cannot tell that from a loss on the way. */
+            if (loss_ > 0 && RandomNext(0, 100) < loss_) {
+                return true;
+            }
+
+            boost::system::error_code ec;
+            socket_->send_to(boost::asio::buffer(p, OVERHEAD + length), remoteEP_, 0, ec);
+            return ec ? false : true;
+        }
+    }
+}
\ No newline at end of file
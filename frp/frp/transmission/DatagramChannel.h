@@ -0,0 +1,89 @@
+#pragma once
+
+#include <frp/IDisposable.h>
+#include <frp/threading/Hosting.h>
+#include <frp/configuration/ForwardErrorCorrectionConfiguration.h>
+
+namespace frp {
+    namespace cryptography {
+        class AeadEncryptor;
+    }
+
+    namespace messages {
+        class Packet;
+    }
+
+    namespace transmission {
+        class ForwardErrorCorrection;
+
+        /* A UDP path beside the transmission for the WriteTo packets of UDP mappings, so they see neither TCP retransmission nor head-of-line blocking.
+         * frps hands the session id and secret over the transmission (PacketCommands_Datagram), so the handshake of the transmission authenticates the channel,
+         * each datagram is session(4) sequence(8) tag(16) and the packet sealed with AES-GCM under a key derived from the secret, replays are dropped.
+         * frpc probes until frps answers and keeps the NAT binding alive afterwards, while no answer comes back the packets stay on the transmission.
+         * With protocol.fec the WriteTo packets also go out in Reed-Solomon groups, the receiving side restores them whenever the sender used it.
+         */
+        class DatagramChannel final : public IDisposable {
+        public:
+            typedef std::function<void(const std::shared_ptr<frp::messages::Packet>&)>  PacketInputCallback;
+
+        public:
+            static const int                                                SECRET_SIZE = 32;
+            static const int                                                OVERHEAD = 4 + 8 + 16;
+
+        public:
+            DatagramChannel(
+                const std::shared_ptr<frp::threading::Hosting>&             hosting,
+                const std::shared_ptr<boost::asio::ip::udp::socket>&        socket,
+                UInt32                                                      session,
+                const std::string&                                          secret,
+                bool                                                        initiator,
+                const frp::configuration::ForwardErrorCorrectionConfiguration& fec) noexcept;
+
+        public:
+            inline UInt32                                                   GetSession() noexcept {
+                return session_;
+            }
+            bool                                                            Open(const boost::asio::ip::udp::endpoint& remoteEP, const BOOST_ASIO_MOVE_ARG(PacketInputCallback) callback) noexcept;
+            void                                                            Close() noexcept;
+            virtual void                                                    Dispose() noexcept override;
+            bool                                                            IsAvailable() noexcept;
+            bool                                                            Input(Byte* buffer, int length, const boost::asio::ip::udp::endpoint& remoteEP) noexcept;
+            bool                                                            WriteTo(const void* buffer, int length, const boost::asio::ip::udp::endpoint& endpoint) noexcept;
+
+        public:
+            static std::string                                              NewSecret() noexcept;
+            static UInt32                                                   GetSession(const Byte* buffer, int length) noexcept;
+
+        private:
+            bool                                                            Probe() noexcept;
+            bool                                                            SendTo(frp::messages::Packet& packet) noexcept;
+            bool                                                            SendTo(int length) noexcept;
+            bool                                                            ReceiveAsync() noexcept;
+            bool                                                            Replayed(UInt64 sequence) noexcept;
+            bool                                                            Output(Byte* buffer, int length) noexcept;
+            void                                                            FlushParity() noexcept;
+
+        private:
+            std::atomic<bool>                                               disposed_;
+            bool                                                            initiator_;
+            UInt32                                                          session_;
+            UInt64                                                          sequence_;
+            UInt64                                                          replay_top_;
+            UInt64                                                          replay_mask_;
+            UInt64                                                          last_;
+            int                                                             loss_;
+            int                                                             fec_interval_;
+            std::shared_ptr<frp::threading::Hosting>                        hosting_;
+            std::shared_ptr<boost::asio::ip::udp::socket>                   socket_;
+            std::shared_ptr<frp::cryptography::AeadEncryptor>               encryptor_;
+            std::shared_ptr<Byte>                                           buffer_;
+            std::shared_ptr<Byte>                                           receive_buffer_;
+            boost::asio::ip::udp::endpoint                                  remoteEP_;
+            boost::asio::ip::udp::endpoint                                  endpoint_;
+            std::shared_ptr<boost::asio::deadline_timer>                    timeout_;
+            std::shared_ptr<ForwardErrorCorrection>                         fec_;
+            std::shared_ptr<boost::asio::deadline_timer>                    fec_timeout_;
+            PacketInputCallback                                             callback_;
+        };
+    }
+}
\ No newline at end of file
@@ -2,60 +2,62 @@
 
 namespace frp {
     namespace transmission {
+        typedef frp::cryptography::Encryptor Encryptor;
+
         EncryptorTransmission::EncryptorTransmission(
             const std::shared_ptr<frp::threading::Hosting>&             hosting, 
             const std::shared_ptr<boost::asio::io_context>&             context, 
             const std::shared_ptr<boost::asio::ip::tcp::socket>&        socket,
             const std::string&                                          method,
-            const std::string&                                          password) noexcept 
-            : Transmission(hosting, context, socket) 
-            , disposed_(false)
+            const std::string&                                          password,
+            bool                                                        pipeline) noexcept 
+            : CipherTransmission(hosting, context, socket, pipeline) 
+            , method_(method)
+            , password_(password)
             , encryptor_(method, password) {
             
         }
 
-        bool EncryptorTransmission::WriteAsync(const std::shared_ptr<Byte>& buffer, int offset, int length, const BOOST_ASIO_MOVE_ARG(WriteAsyncCallback) callback) noexcept {
-            if (!buffer || offset < 0 || length < 1) {
-                return false;
+        bool EncryptorTransmission::OpenLanes(int lanes) noexcept {
+            if (lanes_.size()) {
+                return true;
+            }
+
+            /* Every frame is enciphered from the same key and iv, so any instance opens any frame. */
+            for (int i = 0; i < lanes; i++) {
+                std::shared_ptr<Encryptor> encryptor = make_shared_object<Encryptor>(method_, password_);
+                if (!encryptor) {
+                    lanes_.clear();
+                    return false;
+                }
+                lanes_.emplace_back(encryptor);
+            }
+            return true;
+        }
+
+        Encryptor& EncryptorTransmission::GetEncryptor(int lane) noexcept {
+            if (lane < 0 || lane >= (int)lanes_.size()) {
+                return encryptor_;
             }
+            return *lanes_[lane];
+        }
 
+        EncryptorTransmission::pmessage EncryptorTransmission::Seal(int lane, UInt64 sequence, const Byte* data, int length, const WriteAsyncCallback& callback) noexcept {
             int outlen;
-            const std::shared_ptr<Byte> packet = encryptor_.Encrypt(buffer.get() + offset, length, outlen);
+            const std::shared_ptr<Byte> packet = GetEncryptor(lane).Encrypt(const_cast<Byte*>(data), length, outlen);
             if (!packet || outlen < 1) {
-                return false;
+                return NULL;
             }
 
-            const WriteAsyncCallback callback_ = BOOST_ASIO_MOVE_CAST(WriteAsyncCallback)(constantof(callback));
-            return Transmission::WriteAsync(packet, 0, outlen,
-                [callback_](bool success) noexcept {
-                    if (callback_) {
-                        callback_(success);
-                    }
-                });
+            return Pack(packet.get(), 0, outlen, forward0f(callback));
         }
         
-        bool EncryptorTransmission::ReadAsync(const BOOST_ASIO_MOVE_ARG(ReadAsyncCallback) callback) noexcept {
-            if (!callback) {
-                return false;
+        std::shared_ptr<Byte> EncryptorTransmission::Open(int lane, UInt64 sequence, const std::shared_ptr<Byte>& buffer, int length, int& outlen) noexcept {
+            std::shared_ptr<Byte> packet = GetEncryptor(lane).Decrypt(buffer.get(), length, outlen);
+            if (!packet || outlen < 1) {
+                return NULL;
             }
-
-            const ReadAsyncCallback callback_ = BOOST_ASIO_MOVE_CAST(ReadAsyncCallback)(constantof(callback));
-            return Transmission::ReadAsync(
-                [callback_, this](const std::shared_ptr<Byte>& buffer, int length) noexcept {
-                    if (!buffer || length < 1) {
-                        callback_(buffer, length);
-                        return;
-                    }
-
-                    int outlen;
-                    const std::shared_ptr<Byte> packet = encryptor_.Decrypt(buffer.get(), length, outlen);
-                    if (!packet || outlen < 1) {
-                        callback_(NULL, -1);
-                    }
-                    else {
-                        callback_(packet, outlen);
-                    }
-                });
+            return packet;
         }
     }
 }
\ No newline at end of file
@@ -1,26 +1,33 @@
 #pragma once
 
-#include <frp/transmission/Transmission.h>
+#include <frp/transmission/CipherTransmission.h>
 #include <frp/cryptography/Encryptor.h>
 
 namespace frp {
     namespace transmission {
-        class EncryptorTransmission : public Transmission {
+        class EncryptorTransmission : public CipherTransmission {
         public:
             EncryptorTransmission(
                 const std::shared_ptr<frp::threading::Hosting>&             hosting, 
                 const std::shared_ptr<boost::asio::io_context>&             context, 
                 const std::shared_ptr<boost::asio::ip::tcp::socket>&        socket,
                 const std::string&                                          method,
-                const std::string&                                          password) noexcept;
+                const std::string&                                          password,
+                bool                                                        pipeline) noexcept;
 
-        public:
-            virtual bool                                                    WriteAsync(const std::shared_ptr<Byte>& buffer, int offset, int length, const BOOST_ASIO_MOVE_ARG(WriteAsyncCallback) callback) noexcept override;
-            virtual bool                                                    ReadAsync(const BOOST_ASIO_MOVE_ARG(ReadAsyncCallback) callback) noexcept override;
+        protected:
+            virtual bool                                                    OpenLanes(int lanes) noexcept override;
+            virtual pmessage                                                Seal(int lane, UInt64 sequence, const Byte* data, int length, const WriteAsyncCallback& callback) noexcept override;
+            virtual std::shared_ptr<Byte>                                   Open(int lane, UInt64 sequence, const std::shared_ptr<Byte>& buffer, int length, int& outlen) noexcept override;
+
+        private:
+            frp::cryptography::Encryptor&                                   GetEncryptor(int lane) noexcept;
 
         private:
-            std::atomic<bool>                                               disposed_;
+            std::string                                                     method_;
+            std::string                                                     password_;
             frp::cryptography::Encryptor                                    encryptor_;
+            std::vector<std::shared_ptr<frp::cryptography::Encryptor> >     lanes_;
         };
     }
 }
\ No newline at end of file
@@ -0,0 +1,308 @@
+#include <frp/transmission/ForwardErrorCorrection.h>
+#include <frp/messages/PacketCommands.h>
+
+namespace frp {
+    namespace transmission {
+        static const int FORWARDERRORCORRECTION_WINDOW = 16;
+        static const int FORWARDERRORCORRECTION_SHARDS = ForwardErrorCorrection::MAX_DATA + ForwardErrorCorrection::MAX_PARITY;
+
+        /* GF(2^8) over x^8 + x^4 + x^3 + x^2 + 1, the whole product table keeps the inner loops at one lookup per byte.
+         * The Cauchy rows use x = MAX_DATA + parity index and y = data index, every square submatrix of [I; C] is invertible that way.
+         */
+        static struct ForwardErrorCorrection_GaloisField {
+            Byte                                exp[512];
+            Byte                                log[256];
+            Byte                                mul[256][256];
+            Byte                                cauchy[ForwardErrorCorrection::MAX_PARITY][ForwardErrorCorrection::MAX_DATA];
+
+            ForwardErrorCorrection_GaloisField() noexcept {
+                int x = 1;
+                for (int i = 0; i < 255; i++) {
+                    exp[i] = (Byte)x;
+                    exp[i + 255] = (Byte)x;
+                    log[x] = (Byte)i;
+                    x <<= 1;
+                    if (x & 0x100) {
+                        x ^= 0x11d;
+                    }
+                }
+
+                log[0] = 0;
+                exp[510] = exp[0];
+                exp[511] = exp[1];
+                for (int a = 0; a < 256; a++) {
+                    for (int b = 0; b < 256; b++) {
+                        mul[a][b] = a && b ? exp[log[a] + log[b]] : 0;
+                    }
+                }
+
+                for (int i = 0; i < ForwardErrorCorrection::MAX_PARITY; i++) {
+                    for (int j = 0; j < ForwardErrorCorrection::MAX_DATA; j++) {
+                        cauchy[i][j] = Inverse((Byte)((ForwardErrorCorrection::MAX_DATA + i) ^ j));
+                    }
+                }
+            }
+            inline Byte                         Inverse(Byte a) noexcept {
+                return exp[255 - log[a]];
+            }
+            inline void                         MultiplyAdd(Byte* dst, const Byte* src, int length, Byte c) noexcept {
+                const Byte* m = mul[c];
+                for (int i = 0; i < length; i++) {
+                    dst[i] ^= m[src[i]];
+                }
+            }
+        } FEC_GF;
+
+        ForwardErrorCorrection::ForwardErrorCorrection(int data, int parity) noexcept
+            : data_(std::max<int>(0, std::min<int>(MAX_DATA, data)))
+            , parity_(std::max<int>(1, std::min<int>(MAX_PARITY, parity)))
+            , send_group_(0)
+            , send_count_(0)
+            , send_size_(0)
+            , receive_top_(0) {
+            send_shards_.resize(data_);
+            groups_.resize(FORWARDERRORCORRECTION_WINDOW);
+            for (group& g : groups_) {
+                g.used = false;
+            }
+        }
+
+        static inline void ForwardErrorCorrection_WriteHeader(Byte* frame, UInt32 id, int index, int data, int parity) noexcept {
+            frame[0] = frp::messages::PacketCommands::PacketCommands_Fec;
+            frame[1] = (Byte)(id >> 24);
+            frame[2] = (Byte)(id >> 16);
+            frame[3] = (Byte)(id >> 8);
+            frame[4] = (Byte)(id);
+            frame[5] = (Byte)index;
+            frame[6] = (Byte)data;
+            frame[7] = (Byte)parity;
+        }
+
+        int ForwardErrorCorrection::Encode(Byte* frame, int length) noexcept {
+            if (!IsEncoder() || IsFull() || NULL == frame || length < 1 || length > UINT16_MAX - 2) {
+                return 0;
+            }
+
+            /* The data shard goes out unchanged, the copy kept for the parity carries its length so the receiver can cut a restored one back. */
+            ForwardErrorCorrection_WriteHeader(frame, send_group_, send_count_, 0, 0);
+            std::vector<Byte>& shard = send_shards_[send_count_++];
+            shard.resize(length + 2);
+            shard[0] = (Byte)(length >> 8);
+            shard[1] = (Byte)(length);
+            memcpy(shard.data() + 2, frame + HEADER_SIZE, length);
+
+            send_size_ = std::max<int>(send_size_, length + 2);
+            return HEADER_SIZE + length;
+        }
+
+        int ForwardErrorCorrection::Parity(int index, Byte* frame, int size) noexcept {
+            if (NULL == frame || index < 0 || index >= parity_ || send_count_ < 1 || HEADER_SIZE + send_size_ > size) {
+                return 0;
+            }
+
+            ForwardErrorCorrection_WriteHeader(frame, send_group_, send_count_ + index, send_count_, parity_);
+            Byte* out = frame + HEADER_SIZE;
+            memset(out, 0, send_size_);
+
+            const Byte* row = FEC_GF.cauchy[index];
+            for (int j = 0; j < send_count_; j++) {
+                const std::vector<Byte>& shard = send_shards_[j];
+                FEC_GF.MultiplyAdd(out, shard.data(), (int)shard.size(), row[j]);
+            }
+            return HEADER_SIZE + send_size_;
+        }
+
+        void ForwardErrorCorrection::NextGroup() noexcept {
+            send_group_++;
+            send_count_ = 0;
+            send_size_ = 0;
+        }
+
+        bool ForwardErrorCorrection::Decode(Byte* frame, int length, const ShardOutputCallback& output) noexcept {
+            if (NULL == frame || length <= HEADER_SIZE || frame[0] != frp::messages::PacketCommands::PacketCommands_Fec) {
+                return false;
+            }
+
+            UInt32 id = (UInt32)frame[1] << 24 | (UInt32)frame[2] << 16 | (UInt32)frame[3] << 8 | frame[4];
+            int index = frame[5];
+            int data = frame[6];
+            int parity = frame[7];
+            Byte* shard = frame + HEADER_SIZE;
+            int shard_size = length - HEADER_SIZE;
+
+            bool is_parity = parity > 0;
+            if (is_parity) {
+                if (data < 1 || data > MAX_DATA || parity > MAX_PARITY || index < data || index >= data + parity || shard_size < 3) {
+                    return false;
+                }
+            }
+            elif(data != 0 || index >= MAX_DATA) {
+                return false;
+            }
+
+            /* Only the recent groups are kept, data of an older one is still delivered, it just cannot help restoring anything any more. */
+            if ((int)(id - receive_top_) > 0) {
+                receive_top_ = id;
+            }
+            elif(receive_top_ - id >= (UInt32)FORWARDERRORCORRECTION_WINDOW) {
+                if (is_parity) {
+                    return false;
+                }
+
+                output(shard, shard_size);
+                return true;
+            }
+
+            group& g = groups_[id % FORWARDERRORCORRECTION_WINDOW];
+            if (!g.used || g.id != id) {
+                g.used = true;
+                g.done = false;
+                g.id = id;
+                g.data = 0;
+                g.parity = 0;
+                g.count = 0;
+                g.size = 0;
+                g.present.reset();
+                if (g.shards.empty()) {
+                    g.shards.resize(FORWARDERRORCORRECTION_SHARDS);
+                }
+            }
+
+            /* Already here or already restored, either way delivered once. */
+            if (g.present[index]) {
+                return false;
+            }
+
+            if (is_parity) {
+                if (g.size != 0 && (g.size != shard_size || g.data != data || g.parity != parity)) {
+                    return false;
+                }
+
+                g.data = data;
+                g.parity = parity;
+                g.size = shard_size;
+                g.shards[index].assign(shard, shard + shard_size);
+            }
+            else {
+                std::vector<Byte>& stored = g.shards[index];
+                stored.resize(shard_size + 2);
+                stored[0] = (Byte)(shard_size >> 8);
+                stored[1] = (Byte)(shard_size);
+                memcpy(stored.data() + 2, shard, shard_size);
+            }
+
+            g.present.set(index);
+            g.count++;
+            if (!is_parity) {
+                output(shard, shard_size);
+            }
+
+            if (g.data > 0 && !g.done && g.count >= g.data) {
+                return Recover(g, output);
+            }
+            return true;
+        }
+
+        bool ForwardErrorCorrection::Recover(group& g, const ShardOutputCallback& output) noexcept {
+            const int k = g.data;
+            int missing[MAX_DATA];
+            int missing_count = 0;
+            int rows[MAX_DATA];
+            int row_count = 0;
+
+            for (int j = 0; j < k; j++) {
+                if (g.present[j]) {
+                    rows[row_count++] = j;
+                }
+                else {
+                    missing[missing_count++] = j;
+                }
+            }
+
+            if (missing_count == 0) {
+                g.done = true;
+                return true;
+            }
+
+            for (int i = 0; i < g.parity && row_count < k; i++) {
+                if (g.present[k + i]) {
+                    rows[row_count++] = k + i;
+                }
+            }
+
+            if (row_count < k) {
+                return true; /* Data shards past the announced count were counted, wait for more. */
+            }
+
+            /* Gauss-Jordan on [A | I], A being the rows of [I; C] that arrived, the right half ends up as the inverse. */
+            const int w = k << 1;
+            std::vector<Byte> m(k * w, 0);
+            for (int r = 0; r < k; r++) {
+                Byte* row = m.data() + r * w;
+                if (rows[r] < k) {
+                    row[rows[r]] = 1;
+                }
+                else {
+                    memcpy(row, FEC_GF.cauchy[rows[r] - k], k);
+                }
+                row[k + r] = 1;
+            }
+
+            for (int c = 0; c < k; c++) {
+                int pivot = c;
+                while (pivot < k && m[pivot * w + c] == 0) {
+                    pivot++;
+                }
+
+                if (pivot == k) {
+                    g.done = true;
+                    return false;
+                }
+
+                Byte* row = m.data() + c * w;
+                if (pivot != c) {
+                    std::swap_ranges(row, row + w, m.data() + pivot * w);
+                }
+
+                Byte scale = FEC_GF.Inverse(row[c]);
+                if (scale != 1) {
+                    const Byte* s = FEC_GF.mul[scale];
+                    for (int i = 0; i < w; i++) {
+                        row[i] = s[row[i]];
+                    }
+                }
+
+                for (int r = 0; r < k; r++) {
+                    Byte* other = m.data() + r * w;
+                    if (r != c && other[c] != 0) {
+                        FEC_GF.MultiplyAdd(other, row, w, other[c]);
+                    }
+                }
+            }
+
+            g.done = true;
+            for (int n = 0; n < missing_count; n++) {
+                int j = missing[n];
+                const Byte* coefficients = m.data() + j * w + k;
+
+                std::vector<Byte>& restored = g.shards[j];
+                restored.assign(g.size, 0);
+                for (int r = 0; r < k; r++) {
+                    if (coefficients[r] != 0) {
+                        const std::vector<Byte>& source = g.shards[rows[r]];
+                        FEC_GF.MultiplyAdd(restored.data(), source.data(), std::min<int>(g.size, (int)source.size()), coefficients[r]);
+                    }
+                }
+
+                int length = restored[0] << 8 | restored[1];
+                if (length < 1 || length > g.size - 2) {
+                    continue;
+                }
+
+                g.present.set(j);
+                output(restored.data() + 2, length);
+            }
+            return true;
+        }
+    }
+}
\ No newline at end of file
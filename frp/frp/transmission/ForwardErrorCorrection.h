@@ -0,0 +1,66 @@
+#pragma once
+
+#include <frp/stdafx.h>
+
+namespace frp {
+    namespace transmission {
+        /* Systematic Reed-Solomon erasure code over GF(2^8) with a Cauchy matrix, any Data of the Data + Parity shards of a group restore the rest.
+         * Each frame is command(1) group(4) index(1) data(1) parity(1) and the shard, data shards go out as they are and are delivered on arrival,
+         * parity shards are taken over the data shards prefixed with their length and zero padded to the longest, and name how many data shards the group got.
+         */
+        class ForwardErrorCorrection final {
+        public:
+            typedef std::function<void(Byte*, int)>                         ShardOutputCallback;
+
+        public:
+            static const int                                                HEADER_SIZE = 8;
+            static const int                                                MAX_DATA = 128;
+            static const int                                                MAX_PARITY = 32;
+
+        public:
+            ForwardErrorCorrection(int data, int parity) noexcept;
+
+        public:
+            inline bool                                                     IsEncoder() noexcept {
+                return data_ > 0;
+            }
+            inline int                                                      GetCount() noexcept {
+                return send_count_;
+            }
+            inline bool                                                     IsFull() noexcept {
+                return send_count_ >= data_;
+            }
+            inline int                                                      GetParity() noexcept {
+                return parity_;
+            }
+            int                                                             Encode(Byte* frame, int length) noexcept;
+            int                                                             Parity(int index, Byte* frame, int size) noexcept;
+            void                                                            NextGroup() noexcept;
+            bool                                                            Decode(Byte* frame, int length, const ShardOutputCallback& output) noexcept;
+
+        private:
+            struct group {
+                UInt32                                                      id;
+                bool                                                        used;
+                bool                                                        done;
+                int                                                         data;
+                int                                                         parity;
+                int                                                         count;
+                int                                                         size;
+                std::bitset<MAX_DATA + MAX_PARITY>                          present;
+                std::vector<std::vector<Byte> >                             shards;
+            };
+            bool                                                            Recover(group& g, const ShardOutputCallback& output) noexcept;
+
+        private:
+            int                                                             data_;
+            int                                                             parity_;
+            UInt32                                                          send_group_;
+            int                                                             send_count_;
+            int                                                             send_size_;
+            std::vector<std::vector<Byte> >                                 send_shards_;
+            UInt32                                                          receive_top_;
+            std::vector<group>                                              groups_;
+        };
+    }
+}
\ No newline at end of file
@@ -24,6 +24,10 @@ namespace frp {
             return transmission->GetReference();
         }
 
+        bool ITransmission::SetEarlyData(const std::shared_ptr<Byte>& buffer, int offset, int length) {
+            return false;
+        }
+
         std::shared_ptr<ITransmission> ITransmission::GetReference() noexcept {
             std::weak_ptr<ITransmission> weak = reference_;
             return weak.lock();
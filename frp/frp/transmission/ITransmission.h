@@ -36,6 +36,10 @@ namespace frp {
                 int                                                             offset,
                 int                                                             length,
                 const BOOST_ASIO_MOVE_ARG(WriteAsyncCallback)                   callback) = 0;
+            virtual bool                                                        SetEarlyData(
+                const std::shared_ptr<Byte>&                                    buffer,
+                int                                                             offset,
+                int                                                             length);
 
         public:
             virtual std::shared_ptr<boost::asio::io_context>                    GetContext() = 0;
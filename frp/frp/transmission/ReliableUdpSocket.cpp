@@ -0,0 +1,147 @@
+#include <frp/transmission/ReliableUdpSocket.h>
+#include <frp/transmission/ReliableUdpTransmission.h>
+#include <frp/net/Socket.h>
+
+namespace frp {
+    namespace transmission {
+        static const int RELIABLEUDPSOCKET_BUFFER_SIZE = 4 * 1024 * 1024;
+
+        ReliableUdpSocket::ReliableUdpSocket(const std::shared_ptr<boost::asio::io_context>& context, int loss) noexcept
+            : disposed_(false)
+            , loss_(std::max<int>(0, std::min<int>(100, loss)))
+            , context_(context)
+            , buffer_(make_shared_alloc<Byte>(frp::threading::Hosting::BufferSize))
+            , socket_(*context) {
+
+        }
+
+        bool ReliableUdpSocket::Open(const boost::asio::ip::address& address, int port, const BOOST_ASIO_MOVE_ARG(AcceptAsyncCallback) accept) noexcept {
+            if (disposed_ || !buffer_ || socket_.is_open()) {
+                return false;
+            }
+
+            if (!frp::net::Socket::OpenSocket(socket_, address, port)) {
+                return false;
+            }
+
+            /* A window in flight has to fit into the kernel buffers, or it is the host dropping it rather than the path. */
+            boost::system::error_code ec;
+            socket_.set_option(boost::asio::socket_base::receive_buffer_size(RELIABLEUDPSOCKET_BUFFER_SIZE), ec);
+            socket_.set_option(boost::asio::socket_base::send_buffer_size(RELIABLEUDPSOCKET_BUFFER_SIZE), ec);
+
+            accept_ = BOOST_ASIO_MOVE_CAST(AcceptAsyncCallback)(constantof(accept));
+            return ReceiveAsync();
+        }
+
+        void ReliableUdpSocket::Close() noexcept {
+            if (!disposed_.exchange(true)) {
+                frp::net::Socket::Closesocket(socket_);
+
+                /* The sessions hold the socket and the socket only their weak references, what is still alive goes down with it. */
+                TransmissionTable transmissions = std::move(transmissions_);
+                transmissions_.clear();
+                accept_ = NULL;
+
+                for (auto&& kv : transmissions) {
+                    TransmissionPtr transmission = kv.second.lock();
+                    if (transmission) {
+                        transmission->Close();
+                    }
+                }
+            }
+        }
+
+        void ReliableUdpSocket::Dispose() noexcept {
+            Close();
+        }
+
+        bool ReliableUdpSocket::SendTo(const void* buffer, int length, const boost::asio::ip::udp::endpoint& remoteEP) noexcept {
+            if (disposed_ || !buffer || length < 1) {
+                return false;
+            }
+
+            /* Dropped on purpose, the sender cannot tell that from a loss on the way. */
+            if (loss_ > 0 && RandomNext(0, 100) < loss_) {
+                return true;
+            }
+
+            /* A full send buffer is a lost datagram to the ARQ above, it resends. */
+            boost::system::error_code ec;
+            socket_.send_to(boost::asio::buffer(buffer, length), remoteEP, boost::asio::socket_base::message_flags(), ec);
+            return !ec || ec == boost::asio::error::would_block || ec == boost::asio::error::no_buffer_space;
+        }
+
+        bool ReliableUdpSocket::AddTransmission(UInt32 conv, const TransmissionPtr& transmission) noexcept {
+            if (disposed_ || !transmission) {
+                return false;
+            }
+
+            return transmissions_.emplace(conv, transmission).second;
+        }
+
+        bool ReliableUdpSocket::RemoveTransmission(UInt32 conv, ReliableUdpTransmission* transmission) noexcept {
+            TransmissionTable::iterator tail = transmissions_.find(conv);
+            if (tail == transmissions_.end()) {
+                return false;
+            }
+
+            /* Only the session the id belongs to may take it out, an expired entry goes either way. */
+            TransmissionPtr current = tail->second.lock();
+            if (current && current.get() != transmission) {
+                return false;
+            }
+
+            transmissions_.erase(tail);
+            return true;
+        }
+
+        bool ReliableUdpSocket::ReceiveAsync() noexcept {
+            if (disposed_ || !socket_.is_open()) {
+                return false;
+            }
+
+            const std::shared_ptr<Reference> reference = GetReference();
+            socket_.async_receive_from(boost::asio::buffer(buffer_.get(), frp::threading::Hosting::BufferSize), endpoint_,
+                [reference, this](const boost::system::error_code& ec, std::size_t sz) noexcept {
+                    if (ec == boost::system::errc::operation_canceled || disposed_) {
+                        return;
+                    }
+
+                    /* An ICMP unreachable from one peer surfaces here as an error, the socket itself is still fine. */
+                    if (!ec) {
+                        OnReceive(buffer_.get(), (int)sz);
+                    }
+                    ReceiveAsync();
+                });
+            return true;
+        }
+
+        bool ReliableUdpSocket::OnReceive(const Byte* buffer, int length) noexcept {
+            if (length < ReliableUdpTransmission::OVERHEAD) {
+                return false;
+            }
+
+            UInt32 conv = (UInt32)buffer[0] << 24 | (UInt32)buffer[1] << 16 | (UInt32)buffer[2] << 8 | buffer[3];
+            TransmissionTable::iterator tail = transmissions_.find(conv);
+            if (tail != transmissions_.end()) {
+                TransmissionPtr transmission = tail->second.lock();
+                if (transmission) {
+                    return transmission->Input(buffer, length, endpoint_);
+                }
+
+                transmissions_.erase(tail);
+            }
+
+            /* Only a SYN opens a session, anything else for an unknown id is a leftover of one already gone. */
+            if (!accept_ || buffer[4] != ReliableUdpTransmission::Command_Syn) {
+                return false;
+            }
+
+            TransmissionPtr transmission = accept_(conv, endpoint_);
+            if (!transmission) {
+                return false;
+            }
+            return AddTransmission(conv, transmission);
+        }
+    }
+}
\ No newline at end of file
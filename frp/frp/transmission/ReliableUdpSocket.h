@@ -0,0 +1,53 @@
+#pragma once
+
+#include <frp/IDisposable.h>
+#include <frp/threading/Hosting.h>
+
+namespace frp {
+    namespace transmission {
+        class ReliableUdpTransmission;
+
+        /* The UDP socket under the reliable UDP transmissions, frps shares one among all of its sessions, frpc opens one per transmission.
+         * Datagrams are handed to the session their conversation id names, a SYN for an unknown one goes to the accept handler.
+         */
+        class ReliableUdpSocket final : public IDisposable {
+        public:
+            typedef std::shared_ptr<ReliableUdpTransmission>                TransmissionPtr;
+            typedef std::function<TransmissionPtr(UInt32, const boost::asio::ip::udp::endpoint&)>  AcceptAsyncCallback;
+
+        public:
+            ReliableUdpSocket(const std::shared_ptr<boost::asio::io_context>& context, int loss) noexcept;
+
+        public:
+            inline const std::shared_ptr<boost::asio::io_context>&          GetContext() noexcept {
+                return context_;
+            }
+            inline boost::asio::ip::udp::socket&                            GetSocket() noexcept {
+                return socket_;
+            }
+            bool                                                            Open(const boost::asio::ip::address& address, int port, const BOOST_ASIO_MOVE_ARG(AcceptAsyncCallback) accept) noexcept;
+            void                                                            Close() noexcept;
+            virtual void                                                    Dispose() noexcept override;
+            bool                                                            SendTo(const void* buffer, int length, const boost::asio::ip::udp::endpoint& remoteEP) noexcept;
+            bool                                                            AddTransmission(UInt32 conv, const TransmissionPtr& transmission) noexcept;
+            bool                                                            RemoveTransmission(UInt32 conv, ReliableUdpTransmission* transmission) noexcept;
+
+        private:
+            bool                                                            ReceiveAsync() noexcept;
+            bool                                                            OnReceive(const Byte* buffer, int length) noexcept;
+
+        private:
+            typedef std::unordered_map<UInt32, std::weak_ptr<ReliableUdpTransmission> > TransmissionTable;
+
+        private:
+            std::atomic<bool>                                               disposed_;
+            int                                                             loss_;
+            std::shared_ptr<boost::asio::io_context>                        context_;
+            std::shared_ptr<Byte>                                           buffer_;
+            boost::asio::ip::udp::socket                                    socket_;
+            boost::asio::ip::udp::endpoint                                  endpoint_;
+            AcceptAsyncCallback                                             accept_;
+            TransmissionTable                                               transmissions_;
+        };
+    }
+}
\ No newline at end of file
@@ -0,0 +1,812 @@
+#include <frp/transmission/ReliableUdpTransmission.h>
+#include <frp/transmission/ReliableUdpSocket.h>
+#include <frp/net/IPEndPoint.h>
+
+namespace frp {
+    namespace transmission {
+        static const int    RELIABLEUDP_MIN_MTU     = 576;
+        static const int    RELIABLEUDP_MAX_MTU     = 65507;
+        static const int    RELIABLEUDP_MAX_RTO     = 60000;
+        static const int    RELIABLEUDP_RTO         = 200;
+        static const UInt32 RELIABLEUDP_SYN_RESEND  = 200;
+        static const UInt32 RELIABLEUDP_DEAD_LINK   = 20;
+        static const UInt32 RELIABLEUDP_FAST_LIMIT  = 5;
+        static const int    RELIABLEUDP_MAX_FRG     = 255;
+
+        static inline int ReliableUdp_Diff(UInt32 x, UInt32 y) noexcept {
+            return (int)(x - y);
+        }
+
+        static inline UInt32 ReliableUdp_Now() noexcept {
+            return (UInt32)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        static inline Byte* ReliableUdp_Encode16(Byte* p, UInt32 v) noexcept {
+            p[0] = (Byte)(v >> 8);
+            p[1] = (Byte)(v);
+            return p + 2;
+        }
+
+        static inline Byte* ReliableUdp_Encode32(Byte* p, UInt32 v) noexcept {
+            p[0] = (Byte)(v >> 24);
+            p[1] = (Byte)(v >> 16);
+            p[2] = (Byte)(v >> 8);
+            p[3] = (Byte)(v);
+            return p + 4;
+        }
+
+        static inline UInt32 ReliableUdp_Decode16(const Byte* p) noexcept {
+            return (UInt32)p[0] << 8 | p[1];
+        }
+
+        static inline UInt32 ReliableUdp_Decode32(const Byte* p) noexcept {
+            return (UInt32)p[0] << 24 | (UInt32)p[1] << 16 | (UInt32)p[2] << 8 | p[3];
+        }
+
+        /* conv(4) cmd(1) frg(1) wnd(2) ts(4) sn(4) una(4) len(2), big endian like the rest of the wire. */
+        static inline Byte* ReliableUdp_Encode(Byte* p, UInt32 conv, int cmd, int frg, int wnd, UInt32 ts, UInt32 sn, UInt32 una, int len) noexcept {
+            p = ReliableUdp_Encode32(p, conv);
+            *p++ = (Byte)cmd;
+            *p++ = (Byte)frg;
+            p = ReliableUdp_Encode16(p, wnd);
+            p = ReliableUdp_Encode32(p, ts);
+            p = ReliableUdp_Encode32(p, sn);
+            p = ReliableUdp_Encode32(p, una);
+            return ReliableUdp_Encode16(p, len);
+        }
+
+        ReliableUdpTransmission::ReliableUdpTransmission(
+            const std::shared_ptr<frp::threading::Hosting>&             hosting,
+            const std::shared_ptr<boost::asio::io_context>&             context,
+            const std::shared_ptr<ReliableUdpSocket>&                   socket,
+            UInt32                                                      conv,
+            const boost::asio::ip::udp::endpoint&                       remoteEP,
+            const frp::configuration::ReliableUdpConfiguration&         configuration,
+            bool                                                        owner) noexcept
+            : disposed_(false)
+            , owner_(owner)
+            , established_(false)
+            , flushing_(false)
+            , pacing_(false)
+            , window_update_(false)
+            , hosting_(hosting)
+            , context_(context)
+            , socket_(socket)
+            , timer_(*context)
+            , pacer_(*context)
+            , remoteEP_(remoteEP)
+            , configuration_(configuration)
+            , conv_(conv)
+            , current_(ReliableUdp_Now())
+            , last_(current_)
+            , syn_ts_(current_)
+            , snd_una_(0)
+            , snd_nxt_(0)
+            , rcv_nxt_(0)
+            , rmt_wnd_(configuration.ReceiveWindow)
+            , ssthresh_(configuration.SendWindow)
+            , rx_srtt_(0)
+            , rx_rttval_(0)
+            , rx_rto_(RELIABLEUDP_RTO)
+            , pace_ts_(current_)
+            , pace_budget_(0) {
+            mtu_ = std::max<int>(RELIABLEUDP_MIN_MTU, std::min<int>(RELIABLEUDP_MAX_MTU, configuration_.Mtu));
+            mss_ = mtu_ - OVERHEAD;
+            configuration_.SendWindow = std::max<int>(16, configuration_.SendWindow);
+            configuration_.ReceiveWindow = std::max<int>(RELIABLEUDP_MAX_FRG + 1, configuration_.ReceiveWindow);
+            configuration_.Interval = std::max<int>(1, std::min<int>(100, configuration_.Interval));
+            configuration_.MinRto = std::max<int>(configuration_.Interval, configuration_.MinRto);
+
+            /* A TCP like initial window, slow start from one segment takes too many round trips on a long link. */
+            cwnd_ = std::min<UInt32>(10, configuration_.SendWindow);
+            incr_ = cwnd_ * mss_;
+            buffer_ = make_shared_alloc<Byte>(mtu_);
+        }
+
+        UInt32 ReliableUdpTransmission::NewConversation() noexcept {
+            static std::atomic<UInt32> sequence(0);
+
+            std::random_device rd;
+            UInt32 conv = (UInt32)rd() ^ (++sequence * 2654435761u);
+            return conv ? conv : 1;
+        }
+
+        void ReliableUdpTransmission::Dispose() noexcept {
+            if (disposed_.exchange(true)) {
+                return;
+            }
+
+            /* Best effort, a lost FIN only leaves the peer to its idle timeout. */
+            if (established_ && buffer_) {
+                ReliableUdp_Encode(buffer_.get(), conv_, Command_Fin, 0, 0, current_, 0, rcv_nxt_, 0);
+                socket_->SendTo(buffer_.get(), OVERHEAD, remoteEP_);
+            }
+
+            boost::system::error_code ec;
+            timer_.cancel(ec);
+            pacer_.cancel(ec);
+
+            socket_->RemoveTransmission(conv_, this);
+            if (owner_) {
+                socket_->Close();
+            }
+
+            /* Everyone still waiting hears about it, the same as a closed socket would tell them. */
+            HandshakeAsyncCallback handshake = std::move(handshake_);
+            ReadAsyncCallback read = std::move(read_);
+            std::vector<WriteAsyncCallback> writes;
+            for (segment& seg : snd_queue_) {
+                if (seg.callback) {
+                    writes.push_back(std::move(seg.callback));
+                }
+            }
+
+            snd_queue_.clear();
+            snd_buf_.clear();
+            rcv_queue_.clear();
+            rcv_buf_.clear();
+            acks_.clear();
+
+            if (handshake || read || writes.size()) {
+                const std::shared_ptr<ITransmission> reference = GetReference();
+                boost::asio::post(*context_,
+                    [reference, handshake, read, writes]() noexcept {
+                        if (handshake) {
+                            handshake(false);
+                        }
+
+                        for (const WriteAsyncCallback& callback : writes) {
+                            callback(false);
+                        }
+
+                        if (read) {
+                            read(NULL, -1);
+                        }
+                    });
+            }
+        }
+
+        bool ReliableUdpTransmission::HandshakeAsync(HandshakeType type, const BOOST_ASIO_MOVE_ARG(HandshakeAsyncCallback) callback) noexcept {
+            if (!callback || disposed_ || handshake_ || established_) {
+                return false;
+            }
+
+            handshake_ = BOOST_ASIO_MOVE_CAST(HandshakeAsyncCallback)(constantof(callback));
+            if (!SendSyn() || !Tick()) {
+                handshake_ = NULL;
+                return false;
+            }
+
+            /* frps answers the SYN that created the session, frpc keeps sending its SYN until the answer comes back. */
+            if (type == HandshakeType::HandshakeType_Server) {
+                const std::shared_ptr<ITransmission> reference = GetReference();
+                boost::asio::post(*context_,
+                    [reference, this]() noexcept {
+                        Established();
+                    });
+            }
+            return true;
+        }
+
+        void ReliableUdpTransmission::Established() noexcept {
+            if (disposed_ || established_) {
+                return;
+            }
+
+            established_ = true;
+            HandshakeAsyncCallback handshake = std::move(handshake_);
+            if (handshake) {
+                handshake_ = NULL;
+                handshake(true);
+            }
+        }
+
+        bool ReliableUdpTransmission::SendSyn() noexcept {
+            if (!buffer_) {
+                return false;
+            }
+
+            syn_ts_ = current_;
+            ReliableUdp_Encode(buffer_.get(), conv_, Command_Syn, 0, GetUnusedWindow(), current_, 0, rcv_nxt_, 0);
+            return socket_->SendTo(buffer_.get(), OVERHEAD, remoteEP_);
+        }
+
+        bool ReliableUdpTransmission::Tick() noexcept {
+            if (disposed_) {
+                return false;
+            }
+
+            const std::shared_ptr<ITransmission> reference = GetReference();
+            timer_.expires_from_now(boost::posix_time::milliseconds(configuration_.Interval));
+            timer_.async_wait(
+                [reference, this](const boost::system::error_code& ec) noexcept {
+                    if (ec || disposed_) {
+                        return;
+                    }
+
+                    current_ = ReliableUdp_Now();
+                    if (ReliableUdp_Diff(current_, last_) >= configuration_.Timeout * 1000) {
+                        Close();
+                        return;
+                    }
+
+                    if (!established_ && ReliableUdp_Diff(current_, syn_ts_) >= (int)RELIABLEUDP_SYN_RESEND) {
+                        SendSyn();
+                    }
+
+                    Flush();
+                    Tick();
+                });
+            return true;
+        }
+
+        bool ReliableUdpTransmission::ReadAsync(const BOOST_ASIO_MOVE_ARG(ReadAsyncCallback) callback) noexcept {
+            if (!callback || disposed_ || read_) {
+                return false;
+            }
+
+            read_ = BOOST_ASIO_MOVE_CAST(ReadAsyncCallback)(constantof(callback));
+            if (PeekSize() > 0) {
+                const std::shared_ptr<ITransmission> reference = GetReference();
+                boost::asio::post(*context_,
+                    [reference, this]() noexcept {
+                        Deliver();
+                    });
+            }
+            return true;
+        }
+
+        bool ReliableUdpTransmission::WriteAsync(const std::shared_ptr<Byte>& buffer, int offset, int length, const BOOST_ASIO_MOVE_ARG(WriteAsyncCallback) callback) noexcept {
+            if (!buffer || offset < 0 || length < 1 || disposed_) {
+                return false;
+            }
+
+            int count = (length + mss_ - 1) / mss_;
+            if (count > RELIABLEUDP_MAX_FRG) {
+                return false;
+            }
+
+            std::shared_ptr<Byte> data = make_shared_alloc<Byte>(length);
+            if (!data) {
+                return false;
+            }
+
+            memcpy(data.get(), buffer.get() + offset, length);
+            for (int i = 0; i < count; i++) {
+                segment seg;
+                seg.sn = 0;
+                seg.ts = 0;
+                seg.resendts = 0;
+                seg.rto = 0;
+                seg.fastack = 0;
+                seg.xmit = 0;
+                seg.frg = (Byte)(count - i - 1);
+                seg.data = data;
+                seg.offset = i * mss_;
+                seg.length = std::min<int>(mss_, length - seg.offset);
+
+                /* The caller hears back once its last segment got into the window, that is what keeps it from flooding the queue. */
+                if (i == count - 1) {
+                    seg.callback = BOOST_ASIO_MOVE_CAST(WriteAsyncCallback)(constantof(callback));
+                }
+                snd_queue_.push_back(std::move(seg));
+            }
+
+            FlushAsync();
+            return true;
+        }
+
+        void ReliableUdpTransmission::FlushAsync() noexcept {
+            /* Writes of one loop turn share their datagrams. */
+            if (flushing_) {
+                return;
+            }
+
+            flushing_ = true;
+            const std::shared_ptr<ITransmission> reference = GetReference();
+            boost::asio::post(*context_,
+                [reference, this]() noexcept {
+                    flushing_ = false;
+                    current_ = ReliableUdp_Now();
+                    Flush();
+                });
+        }
+
+        void ReliableUdpTransmission::PaceAsync() noexcept {
+            /* The budget refills with the clock, not with the ACKs, so a paced out sender must not sleep until the next tick. */
+            if (pacing_ || disposed_) {
+                return;
+            }
+
+            pacing_ = true;
+            const std::shared_ptr<ITransmission> reference = GetReference();
+            pacer_.expires_from_now(boost::posix_time::milliseconds(1));
+            pacer_.async_wait(
+                [reference, this](const boost::system::error_code& ec) noexcept {
+                    pacing_ = false;
+                    if (!ec && !disposed_) {
+                        current_ = ReliableUdp_Now();
+                        Flush();
+                    }
+                });
+        }
+
+        int ReliableUdpTransmission::GetUnusedWindow() noexcept {
+            int size = (int)rcv_queue_.size();
+            return size < configuration_.ReceiveWindow ? configuration_.ReceiveWindow - size : 0;
+        }
+
+        int ReliableUdpTransmission::PeekSize() noexcept {
+            if (rcv_queue_.empty()) {
+                return -1;
+            }
+
+            const segment& front = rcv_queue_.front();
+            if (front.frg == 0) {
+                return front.length;
+            }
+
+            if (rcv_queue_.size() < (std::size_t)front.frg + 1) {
+                return -1;
+            }
+
+            int length = 0;
+            for (const segment& seg : rcv_queue_) {
+                length += seg.length;
+                if (seg.frg == 0) {
+                    break;
+                }
+            }
+            return length;
+        }
+
+        bool ReliableUdpTransmission::Deliver() noexcept {
+            if (disposed_ || !read_) {
+                return false;
+            }
+
+            int length = PeekSize();
+            if (length < 1) {
+                return false;
+            }
+
+            /* A peer that saw the window closed waits for the update. */
+            bool full = GetUnusedWindow() < 1;
+            std::shared_ptr<Byte> message;
+            if (rcv_queue_.front().frg == 0) {
+                message = std::move(rcv_queue_.front().data);
+                rcv_queue_.pop_front();
+            }
+            else {
+                message = make_shared_alloc<Byte>(length);
+                if (!message) {
+                    return false;
+                }
+
+                int offset = 0;
+                for (;;) {
+                    segment& seg = rcv_queue_.front();
+                    memcpy(message.get() + offset, seg.data.get(), seg.length);
+                    offset += seg.length;
+
+                    bool last = seg.frg == 0;
+                    rcv_queue_.pop_front();
+                    if (last) {
+                        break;
+                    }
+                }
+            }
+
+            /* Room in the queue again, what waited out of order moves in. */
+            while (!rcv_buf_.empty()) {
+                segment_table::iterator tail = rcv_buf_.begin();
+                if (tail->first != rcv_nxt_ || (int)rcv_queue_.size() >= configuration_.ReceiveWindow) {
+                    break;
+                }
+
+                rcv_queue_.push_back(std::move(tail->second));
+                rcv_buf_.erase(tail);
+                rcv_nxt_++;
+            }
+
+            if (full) {
+                window_update_ = true;
+                FlushAsync();
+            }
+
+            ReadAsyncCallback read = std::move(read_);
+            read_ = NULL;
+            read(message, length);
+            return true;
+        }
+
+        bool ReliableUdpTransmission::Input(const Byte* buffer, int length, const boost::asio::ip::udp::endpoint& remoteEP) noexcept {
+            if (disposed_ || !buffer || length < OVERHEAD) {
+                return false;
+            }
+
+            /* The conversation id only picks the session, the peer has to be the one it was opened with. */
+            if (remoteEP != remoteEP_) {
+                return false;
+            }
+
+            current_ = ReliableUdp_Now();
+            last_ = current_;
+
+            UInt32 prev_una = snd_una_;
+            UInt32 maxack = 0;
+            bool acked = false;
+            while (length >= OVERHEAD) {
+                UInt32 conv = ReliableUdp_Decode32(buffer);
+                int cmd = buffer[4];
+                int frg = buffer[5];
+                UInt32 wnd = ReliableUdp_Decode16(buffer + 6);
+                UInt32 ts = ReliableUdp_Decode32(buffer + 8);
+                UInt32 sn = ReliableUdp_Decode32(buffer + 12);
+                UInt32 una = ReliableUdp_Decode32(buffer + 16);
+                int len = (int)ReliableUdp_Decode16(buffer + 20);
+
+                buffer += OVERHEAD;
+                length -= OVERHEAD;
+                if (conv != conv_ || len > length) {
+                    break;
+                }
+
+                rmt_wnd_ = wnd;
+                ParseUna(una);
+                ShrinkBuf();
+
+                if (cmd == Command_Ack) {
+                    int rtt = ReliableUdp_Diff(current_, ts);
+                    if (rtt >= 0) {
+                        UpdateAck(rtt);
+                    }
+
+                    ParseAck(sn);
+                    ShrinkBuf();
+                    if (!acked || ReliableUdp_Diff(sn, maxack) > 0) {
+                        maxack = sn;
+                    }
+                    acked = true;
+                }
+                elif(cmd == Command_Push) {
+                    if (ReliableUdp_Diff(sn, rcv_nxt_ + configuration_.ReceiveWindow) < 0) {
+                        acks_.push_back(std::make_pair(sn, ts));
+                        if (ReliableUdp_Diff(sn, rcv_nxt_) >= 0 && len > 0) {
+                            segment seg;
+                            seg.sn = sn;
+                            seg.ts = ts;
+                            seg.resendts = 0;
+                            seg.rto = 0;
+                            seg.fastack = 0;
+                            seg.xmit = 0;
+                            seg.frg = (Byte)frg;
+                            seg.data = make_shared_alloc<Byte>(len);
+                            seg.offset = 0;
+                            seg.length = len;
+                            if (seg.data) {
+                                memcpy(seg.data.get(), buffer, len);
+                                ParseData(seg);
+                            }
+                        }
+                    }
+
+                    /* Data means frpc's SYN got through, even if frps' answer did not. */
+                    Established();
+                }
+                elif(cmd == Command_Syn) {
+                    if (handshake_ || established_) {
+                        if (owner_) {
+                            Established();
+                        }
+                        else {
+                            SendSyn(); /* frpc never saw the answer, it is still asking. */
+                        }
+                    }
+                }
+                elif(cmd == Command_Fin) {
+                    Close();
+                    return false;
+                }
+
+                buffer += len;
+                length -= len;
+            }
+
+            if (acked) {
+                ParseFastack(maxack);
+            }
+
+            /* KCP's window growth: one segment per ACK in slow start, about one per window past the threshold. */
+            if (configuration_.Congestion && ReliableUdp_Diff(snd_una_, prev_una) > 0 && cwnd_ < rmt_wnd_) {
+                UInt32 mss = (UInt32)mss_;
+                if (cwnd_ < ssthresh_) {
+                    cwnd_++;
+                    incr_ += mss;
+                }
+                else {
+                    if (incr_ < mss) {
+                        incr_ = mss;
+                    }
+
+                    incr_ += (mss * mss) / incr_ + (mss / 16);
+                    if ((cwnd_ + 1) * mss <= incr_) {
+                        cwnd_ = (incr_ + mss - 1) / (mss > 0 ? mss : 1);
+                    }
+                }
+
+                if (cwnd_ > rmt_wnd_) {
+                    cwnd_ = rmt_wnd_;
+                    incr_ = rmt_wnd_ * mss;
+                }
+            }
+
+            Flush();
+            if (read_ && PeekSize() > 0) {
+                Deliver();
+            }
+            return true;
+        }
+
+        void ReliableUdpTransmission::UpdateAck(int rtt) noexcept {
+            if (rx_srtt_ == 0) {
+                rx_srtt_ = rtt;
+                rx_rttval_ = rtt / 2;
+            }
+            else {
+                int delta = rtt - rx_srtt_;
+                if (delta < 0) {
+                    delta = -delta;
+                }
+
+                rx_rttval_ = (3 * rx_rttval_ + delta) / 4;
+                rx_srtt_ = (7 * rx_srtt_ + rtt) / 8;
+                if (rx_srtt_ < 1) {
+                    rx_srtt_ = 1;
+                }
+            }
+
+            int rto = rx_srtt_ + std::max<int>(configuration_.Interval, 4 * rx_rttval_);
+            rx_rto_ = std::max<int>(configuration_.MinRto, std::min<int>(RELIABLEUDP_MAX_RTO, rto));
+        }
+
+        void ReliableUdpTransmission::ShrinkBuf() noexcept {
+            snd_una_ = snd_buf_.empty() ? snd_nxt_ : snd_buf_.front().sn;
+        }
+
+        void ReliableUdpTransmission::ParseAck(UInt32 sn) noexcept {
+            if (ReliableUdp_Diff(sn, snd_una_) < 0 || ReliableUdp_Diff(sn, snd_nxt_) >= 0) {
+                return;
+            }
+
+            for (segment_list::iterator tail = snd_buf_.begin(); tail != snd_buf_.end(); tail++) {
+                if (tail->sn == sn) {
+                    snd_buf_.erase(tail);
+                    break;
+                }
+
+                if (ReliableUdp_Diff(sn, tail->sn) < 0) {
+                    break;
+                }
+            }
+        }
+
+        void ReliableUdpTransmission::ParseUna(UInt32 una) noexcept {
+            while (!snd_buf_.empty() && ReliableUdp_Diff(una, snd_buf_.front().sn) > 0) {
+                snd_buf_.pop_front();
+            }
+        }
+
+        void ReliableUdpTransmission::ParseFastack(UInt32 sn) noexcept {
+            if (ReliableUdp_Diff(sn, snd_una_) < 0 || ReliableUdp_Diff(sn, snd_nxt_) >= 0) {
+                return;
+            }
+
+            for (segment& seg : snd_buf_) {
+                if (ReliableUdp_Diff(sn, seg.sn) < 0) {
+                    break;
+                }
+                elif(sn != seg.sn) {
+                    seg.fastack++;
+                }
+            }
+        }
+
+        void ReliableUdpTransmission::ParseData(segment& seg) noexcept {
+            UInt32 sn = seg.sn;
+            if (ReliableUdp_Diff(sn, rcv_nxt_ + configuration_.ReceiveWindow) >= 0 || ReliableUdp_Diff(sn, rcv_nxt_) < 0) {
+                return;
+            }
+
+            rcv_buf_.emplace(sn, std::move(seg));
+            while (!rcv_buf_.empty()) {
+                segment_table::iterator tail = rcv_buf_.begin();
+                if (tail->first != rcv_nxt_ || (int)rcv_queue_.size() >= configuration_.ReceiveWindow) {
+                    break;
+                }
+
+                rcv_queue_.push_back(std::move(tail->second));
+                rcv_buf_.erase(tail);
+                rcv_nxt_++;
+            }
+        }
+
+        void ReliableUdpTransmission::Flush() noexcept {
+            if (disposed_ || !buffer_) {
+                return;
+            }
+
+            Byte* datagram = buffer_.get();
+            int size = 0;
+            auto output = [this, datagram, &size]() noexcept {
+                if (size > 0) {
+                    socket_->SendTo(datagram, size, remoteEP_);
+                    size = 0;
+                }
+            };
+
+            int wnd = GetUnusedWindow();
+            for (const std::pair<UInt32, UInt32>& ack : acks_) {
+                if (size + OVERHEAD > mtu_) {
+                    output();
+                }
+                ReliableUdp_Encode(datagram + size, conv_, Command_Ack, 0, wnd, ack.second, ack.first, rcv_nxt_, 0);
+                size += OVERHEAD;
+            }
+            acks_.clear();
+
+            if (window_update_) {
+                window_update_ = false;
+                if (size + OVERHEAD > mtu_) {
+                    output();
+                }
+                ReliableUdp_Encode(datagram + size, conv_, Command_Window, 0, wnd, current_, 0, rcv_nxt_, 0);
+                size += OVERHEAD;
+            }
+
+            /* Nothing leaves before frpc knows frps has the session. */
+            if (!established_) {
+                output();
+                return;
+            }
+
+            /* A closed remote window still lets one segment through, its ACK brings the window that opened meanwhile. */
+            UInt32 cwnd = std::min<UInt32>(configuration_.SendWindow, rmt_wnd_);
+            if (configuration_.Congestion) {
+                cwnd = std::min<UInt32>(cwnd, cwnd_);
+            }
+
+            if (cwnd < 1) {
+                cwnd = 1;
+            }
+
+            while (!snd_queue_.empty() && ReliableUdp_Diff(snd_nxt_, snd_una_ + cwnd) < 0) {
+                segment seg = std::move(snd_queue_.front());
+                snd_queue_.pop_front();
+
+                seg.sn = snd_nxt_++;
+                seg.xmit = 0;
+                seg.fastack = 0;
+                seg.rto = rx_rto_;
+                seg.resendts = current_;
+
+                WriteAsyncCallback callback = std::move(seg.callback);
+                seg.callback = NULL;
+                snd_buf_.push_back(std::move(seg));
+
+                if (callback) {
+                    const std::shared_ptr<ITransmission> reference = GetReference();
+                    boost::asio::post(*context_,
+                        [reference, callback]() noexcept {
+                            callback(true);
+                        });
+                }
+            }
+
+            /* Pacing spreads a window over the RTT instead of bursting it into the bottleneck queue. */
+            if (configuration_.Pacing) {
+                int srtt = std::max<int>(1, rx_srtt_ ? rx_srtt_ : rx_rto_);
+                int64_t rate = (int64_t)cwnd * mss_ * 5 / 4;
+                int64_t elapsed = std::max<int>(0, ReliableUdp_Diff(current_, pace_ts_));
+                int64_t burst = std::max<int64_t>(std::max<int64_t>((int64_t)cwnd * mss_ / 4, rate / srtt), 2 * mtu_); /* Never less than a clock tick's worth. */
+
+                pace_ts_ = current_;
+                pace_budget_ = std::min<int64_t>(burst, pace_budget_ + rate * elapsed / srtt);
+            }
+
+            UInt32 resent = configuration_.FastResend > 0 ? (UInt32)configuration_.FastResend : UINT_MAX;
+            bool lost = false;
+            bool dead = false;
+            bool paced = false;
+            int change = 0;
+            for (segment& seg : snd_buf_) {
+                int reason = 0;
+                if (seg.xmit == 0) {
+                    reason = 1;
+                }
+                elif(ReliableUdp_Diff(current_, seg.resendts) >= 0) {
+                    reason = 2;
+                }
+                elif(seg.fastack >= resent && seg.xmit <= RELIABLEUDP_FAST_LIMIT) { /* Past the limit only the RTO, which backs off, sends it again. */
+                    reason = 3;
+                }
+                else {
+                    continue;
+                }
+
+                int need = OVERHEAD + seg.length;
+                if (configuration_.Pacing) {
+                    if (pace_budget_ < need) {
+                        paced = true;
+                        break;
+                    }
+                    pace_budget_ -= need;
+                }
+
+                seg.xmit++;
+                if (reason == 1) {
+                    seg.rto = rx_rto_;
+                }
+                elif(reason == 2) {
+                    seg.rto += std::max<UInt32>(seg.rto, (UInt32)rx_rto_) / 2;
+                    lost = true;
+                }
+                else {
+                    seg.fastack = 0;
+                    change++;
+                }
+
+                seg.ts = current_;
+                seg.resendts = current_ + seg.rto;
+                if (size + need > mtu_) {
+                    output();
+                }
+
+                ReliableUdp_Encode(datagram + size, conv_, Command_Push, seg.frg, wnd, seg.ts, seg.sn, rcv_nxt_, seg.length);
+                memcpy(datagram + size + OVERHEAD, seg.data.get() + seg.offset, seg.length);
+                size += need;
+
+                if (seg.xmit >= RELIABLEUDP_DEAD_LINK) {
+                    dead = true;
+                }
+            }
+            output();
+
+            if (configuration_.Congestion) {
+                if (change) {
+                    UInt32 inflight = snd_nxt_ - snd_una_;
+                    ssthresh_ = std::max<UInt32>(2, inflight / 2);
+                    cwnd_ = ssthresh_ + resent;
+                    incr_ = cwnd_ * mss_;
+                }
+
+                if (lost) {
+                    ssthresh_ = std::max<UInt32>(2, cwnd / 2);
+                    cwnd_ = 1;
+                    incr_ = mss_;
+                }
+            }
+
+            if (paced) {
+                PaceAsync();
+            }
+
+            if (dead) {
+                Close();
+            }
+        }
+
+        std::shared_ptr<boost::asio::io_context> ReliableUdpTransmission::GetContext() noexcept {
+            return context_;
+        }
+
+        frp::net::IPEndPoint ReliableUdpTransmission::GetLocalEndPoint() noexcept {
+            boost::system::error_code ec;
+            return frp::net::IPEndPoint::ToEndPoint(socket_->GetSocket().local_endpoint(ec));
+        }
+
+        frp::net::IPEndPoint ReliableUdpTransmission::GetRemoteEndPoint() noexcept {
+            return frp::net::IPEndPoint::ToEndPoint(remoteEP_);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <frp/threading/Hosting.h>
+#include <frp/transmission/ITransmission.h>
+#include <frp/configuration/ReliableUdpConfiguration.h>
+
+namespace frp {
+    namespace transmission {
+        class ReliableUdpSocket;
+
+        /* A KCP style ARQ session over UDP: frames are cut into MTU sized segments, every segment is acknowledged on its own (selective ACK)
+         * besides the cumulative una carried in every header, a segment skipped over by fast-resend later ACKs is sent again before its RTO,
+         * and the sending rate follows a congestion window (slow start, AIMD) paced over the RTT, so one lost datagram stalls nothing but itself.
+         */
+        class ReliableUdpTransmission : public ITransmission {
+        public:
+            static const int                                                OVERHEAD = 22;
+            typedef enum {
+                Command_Push = 1,
+                Command_Ack,
+                Command_Syn,
+                Command_Fin,
+                Command_Window,
+            }                                                               Command;
+
+        public:
+            ReliableUdpTransmission(
+                const std::shared_ptr<frp::threading::Hosting>&             hosting,
+                const std::shared_ptr<boost::asio::io_context>&             context,
+                const std::shared_ptr<ReliableUdpSocket>&                   socket,
+                UInt32                                                      conv,
+                const boost::asio::ip::udp::endpoint&                       remoteEP,
+                const frp::configuration::ReliableUdpConfiguration&         configuration,
+                bool                                                        owner) noexcept;
+
+        public:
+            virtual void                                                    Dispose() noexcept override;
+            virtual bool                                                    HandshakeAsync(HandshakeType type, const BOOST_ASIO_MOVE_ARG(HandshakeAsyncCallback) callback) noexcept override;
+            virtual bool                                                    ReadAsync(const BOOST_ASIO_MOVE_ARG(ReadAsyncCallback) callback) noexcept override;
+            virtual bool                                                    WriteAsync(const std::shared_ptr<Byte>& buffer, int offset, int length, const BOOST_ASIO_MOVE_ARG(WriteAsyncCallback) callback) noexcept override;
+            bool                                                            Input(const Byte* buffer, int length, const boost::asio::ip::udp::endpoint& remoteEP) noexcept;
+            static UInt32                                                   NewConversation() noexcept;
+
+        public:
+            virtual std::shared_ptr<boost::asio::io_context>                GetContext() noexcept override;
+            virtual frp::net::IPEndPoint                                    GetLocalEndPoint() noexcept override;
+            virtual frp::net::IPEndPoint                                    GetRemoteEndPoint() noexcept override;
+
+        private:
+            struct segment {
+                UInt32                                                      sn;
+                UInt32                                                      ts;
+                UInt32                                                      resendts;
+                UInt32                                                      rto;
+                UInt32                                                      fastack;
+                UInt32                                                      xmit;
+                Byte                                                        frg;
+                std::shared_ptr<Byte>                                       data;
+                int                                                         offset;
+                int                                                         length;
+                WriteAsyncCallback                                          callback;
+            };
+            struct segment_less {
+                inline bool                                                 operator()(UInt32 x, UInt32 y) const noexcept {
+                    return (int)(x - y) < 0;
+                }
+            };
+            typedef std::list<segment>                                      segment_list;
+            typedef std::map<UInt32, segment, segment_less>                 segment_table;
+            typedef std::vector<std::pair<UInt32, UInt32> >                 ack_list;
+
+        private:
+            bool                                                            Tick() noexcept;
+            void                                                            Flush() noexcept;
+            void                                                            FlushAsync() noexcept;
+            void                                                            PaceAsync() noexcept;
+            bool                                                            Deliver() noexcept;
+            bool                                                            SendSyn() noexcept;
+            void                                                            Established() noexcept;
+            void                                                            UpdateAck(int rtt) noexcept;
+            void                                                            ParseAck(UInt32 sn) noexcept;
+            void                                                            ParseUna(UInt32 una) noexcept;
+            void                                                            ParseFastack(UInt32 sn) noexcept;
+            void                                                            ParseData(segment& seg) noexcept;
+            void                                                            ShrinkBuf() noexcept;
+            int                                                             GetUnusedWindow() noexcept;
+            int                                                             PeekSize() noexcept;
+
+        private:
+            std::atomic<bool>                                               disposed_;
+            bool                                                            owner_;
+            bool                                                            established_;
+            bool                                                            flushing_;
+            bool                                                            pacing_;
+            bool                                                            window_update_;
+            std::shared_ptr<frp::threading::Hosting>                        hosting_;
+            std::shared_ptr<boost::asio::io_context>                        context_;
+            std::shared_ptr<ReliableUdpSocket>                              socket_;
+            boost::asio::deadline_timer                                     timer_;
+            boost::asio::deadline_timer                                     pacer_;
+            boost::asio::ip::udp::endpoint                                  remoteEP_;
+            frp::configuration::ReliableUdpConfiguration                    configuration_;
+            UInt32                                                          conv_;
+            int                                                             mtu_;
+            int                                                             mss_;
+            UInt32                                                          current_;
+            UInt32                                                          last_;
+            UInt32                                                          syn_ts_;
+            UInt32                                                          snd_una_;
+            UInt32                                                          snd_nxt_;
+            UInt32                                                          rcv_nxt_;
+            UInt32                                                          rmt_wnd_;
+            UInt32                                                          cwnd_;
+            UInt32                                                          ssthresh_;
+            UInt32                                                          incr_;
+            int                                                             rx_srtt_;
+            int                                                             rx_rttval_;
+            int                                                             rx_rto_;
+            UInt32                                                          pace_ts_;
+            int64_t                                                         pace_budget_;
+            segment_list                                                    snd_queue_;
+            segment_list                                                    snd_buf_;
+            segment_list                                                    rcv_queue_;
+            segment_table                                                   rcv_buf_;
+            ack_list                                                        acks_;
+            std::shared_ptr<Byte>                                           buffer_;
+            HandshakeAsyncCallback                                          handshake_;
+            ReadAsyncCallback                                               read_;
+        };
+    }
+}
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include <frp/transmission/SslSocketTransmission.h>
 #include <frp/transmission/templates/SslSocket.hpp>
+#include <frp/ssl/SslHandshake.h>
+#include <frp/ssl/SslSocketStream.h>
 #include <frp/net/Socket.h>
+#include <frp/threading/Hosting.h>
 
 namespace frp {
     namespace transmission {
@@ -14,7 +17,10 @@ namespace frp {
             const std::string&                                      certificate_key_file,
             const std::string&                                      certificate_chain_file,
             const std::string&                                      certificate_key_password,
-            const std::string&                                      ciphersuites) noexcept 
+            const std::string&                                      ciphersuites,
+            const std::string&                                      session_ticket_key_file,
+            bool                                                    early_data,
+            bool                                                    ktls) noexcept 
             : Transmission(hosting, context, socket)
             , disposed_(false)
             , verify_peer_(verify_peer)
@@ -23,7 +29,12 @@ namespace frp {
             , certificate_key_file_(certificate_key_file)
             , certificate_chain_file_(certificate_chain_file)
             , certificate_key_password_(certificate_key_password)
-            , ciphersuites_(ciphersuites) {
+            , ciphersuites_(ciphersuites)
+            , session_ticket_key_file_(session_ticket_key_file)
+            , early_data_(early_data)
+            , early_buffer_size_(0)
+            , early_buffer_offset_(0)
+            , ktls_(ktls) {
 
         }
 
@@ -33,7 +44,8 @@ namespace frp {
             const std::shared_ptr<boost::asio::ip::tcp::socket>&    socket,
             bool                                                    verify_peer,
             const std::string&                                      host,
-            const std::string&                                      ciphersuites) noexcept 
+            const std::string&                                      ciphersuites,
+            bool                                                    ktls) noexcept 
             : SslSocketTransmission(
                 hosting, 
                 context, 
@@ -44,7 +56,10 @@ namespace frp {
                 "", 
                 "", 
                 "", 
-                ciphersuites) {
+                ciphersuites,
+                "",
+                false,
+                ktls) {
             
         }
                                                                     
@@ -57,7 +72,10 @@ namespace frp {
             const std::string&                                      certificate_key_file,
             const std::string&                                      certificate_chain_file,
             const std::string&                                      certificate_key_password,
-            const std::string&                                      ciphersuites) noexcept 
+            const std::string&                                      ciphersuites,
+            const std::string&                                      session_ticket_key_file,
+            bool                                                    early_data,
+            bool                                                    ktls) noexcept 
             : SslSocketTransmission(
                 hosting,
                 context, 
@@ -68,27 +86,35 @@ namespace frp {
                 certificate_key_file, 
                 certificate_chain_file,
                 certificate_key_password,
-                ciphersuites) {
+                ciphersuites,
+                session_ticket_key_file,
+                early_data,
+                ktls) {
         
         }
 
         bool SslSocketTransmission::OnWriteAsync(const BOOST_ASIO_MOVE_ARG(pmessage) message) noexcept {
             const std::shared_ptr<ITransmission> reference = GetReference();
             const pmessage messages = BOOST_ASIO_MOVE_CAST(pmessage)(constantof(message));
+            const auto handler = [reference, this, messages](const boost::system::error_code& ec, size_t sz) noexcept {
+                bool success = ec ? false : true;
+                if (!success) {
+                    Close();
+                }
 
-            boost::asio::async_write(*ssl_socket_, boost::asio::buffer(messages->packet.get(), messages->packet_size),
-                [reference, this, messages](const boost::system::error_code& ec, size_t sz) noexcept {
-                    bool success = ec ? false : true;
-                    if (!success) {
-                        Close();
-                    }
+                const WriteAsyncCallback& callback = messages->callback;
+                if (callback) {
+                    callback(success);
+                }
+                OnAsyncWrite(true);
+            };
 
-                    const WriteAsyncCallback& callback = messages->callback;
-                    if (callback) {
-                        callback(success);
-                    }
-                    OnAsyncWrite(true);
-                });
+            if (ktls_stream_) {
+                boost::asio::async_write(*ktls_stream_, boost::asio::buffer(messages->packet.get(), messages->packet_size), handler);
+            }
+            else {
+                boost::asio::async_write(*ssl_socket_, boost::asio::buffer(messages->packet.get(), messages->packet_size), handler);
+            }
             return true;
         }
 
@@ -98,6 +124,17 @@ namespace frp {
                 if (!ssl_socket) {
                     Transmission::Dispose();
                 }
+                elif(handshake_) {
+                    /* A worker may be inside the SSL right now, no close_notify then, the handshake winds down once the socket is gone. */
+                    Transmission::Dispose();
+                    frp::net::Socket::Closesocket(ssl_socket->next_layer());
+                }
+                elif(ktls_stream_) {
+                    /* asio's engine lost its BIO to the socket, a best effort close_notify goes straight out instead. */
+                    SSL_shutdown(ssl_socket->native_handle());
+                    Transmission::Dispose();
+                    frp::net::Socket::Closesocket(ssl_socket->next_layer());
+                }
                 else {
                     const std::shared_ptr<ITransmission> reference = GetReference();
                     ssl_socket->async_shutdown(
@@ -127,8 +164,10 @@ namespace frp {
                     std::string& certificate_key_file,
                     std::string& certificate_chain_file,
                     std::string& certificate_key_password,
-                    std::string& ciphersuites) noexcept
-                    : SslSocket(tcp_socket, ssl_context, ssl_socket, verify_peer, host, certificate_file, certificate_key_file, certificate_chain_file, certificate_key_password, ciphersuites)
+                    std::string& ciphersuites,
+                    std::string& session_ticket_key_file,
+                    bool& early_data) noexcept
+                    : SslSocket(tcp_socket, ssl_context, ssl_socket, verify_peer, host, certificate_file, certificate_key_file, certificate_chain_file, certificate_key_password, ciphersuites, session_ticket_key_file, early_data)
                     , transmission_(transmission) {
 
                 }
@@ -150,6 +189,12 @@ namespace frp {
                     const std::shared_ptr<Reference> reference_ = GetReference();
                     const HandshakeAsyncCallback callback_ = BOOST_ASIO_MOVE_CAST(HandshakeAsyncCallback)(constantof(callback));
 
+                    // TLS 1.3 early data (the frpc side only has something to send once a mapping request was handed over), kTLS and the handshake workers.
+                    bool client = type == HandshakeType::HandshakeType_Client;
+                    if (transmission_->ktls_ || transmission_->GetHosting()->GetWorkers() || (client ? NULL != transmission_->early_message_ : transmission_->early_data_)) {
+                        return PerformSslSocketHandshakeAsync(client, forward0f(callback_));
+                    }
+
                     // Perform the SSL handshake.
                     boost::asio::ssl::stream_base::handshake_type handshakeType = type != HandshakeType::HandshakeType_Client ?
                         boost::asio::ssl::stream_base::server : boost::asio::ssl::stream_base::client;
@@ -165,13 +210,70 @@ namespace frp {
                     return true;
                 }
 
+                inline bool PerformSslSocketHandshakeAsync(bool client, const BOOST_ASIO_MOVE_ARG(HandshakeAsyncCallback) callback) noexcept {
+                    SslSocketPtr& ssl_socket = GetSslSocket();
+                    std::shared_ptr<frp::ssl::SslHandshake> handshake = NewReference<frp::ssl::SslHandshake>(ssl_socket->native_handle(), ssl_socket->next_layer());
+                    if (!handshake) {
+                        return false;
+                    }
+
+                    if (transmission_->ktls_) {
+                        handshake->SetKernelTls();
+                    }
+
+                    handshake->SetWorkers(transmission_->GetHosting()->GetWorkers());
+                    transmission_->handshake_ = handshake;
+
+                    const pmessage message_ = std::move(transmission_->early_message_);
+                    const std::shared_ptr<Reference> reference_ = GetReference();
+                    const HandshakeAsyncCallback callback_ = BOOST_ASIO_MOVE_CAST(HandshakeAsyncCallback)(constantof(callback));
+                    bool handshaking = handshake->HandshakeAsync(client, message_ ? message_->packet : NULL, message_ ? message_->packet_size : 0,
+                        [reference_, this, handshake, client, message_, callback_](bool success) noexcept {
+                            const std::shared_ptr<SslSocketTransmission> transmission = transmission_;
+                            if (transmission) {
+                                transmission->handshake_.reset();
+                            }
+
+                            if (!transmission || transmission->disposed_) {
+                                success = false;
+                            }
+                            elif(success) {
+                                /* Without kernel support the asio stream got its BIO back and nothing changes. */
+                                if (handshake->IsKernelTls()) {
+                                    SslSocketPtr& ssl_socket = GetSslSocket();
+                                    transmission->ktls_stream_ = make_shared_object<frp::ssl::SslSocketStream>(ssl_socket->native_handle(), ssl_socket->next_layer());
+                                    success = NULL != transmission->ktls_stream_;
+                                }
+
+                                if (!client) {
+                                    transmission->early_buffer_ = handshake->GetEarlyData(transmission->early_buffer_size_);
+                                    transmission->early_buffer_offset_ = 0;
+                                }
+                                elif(message_ && !handshake->IsEarlyDataAccepted()) {
+                                    /* frps turned down (or was never offered) the early data, so it leads the ordinary frames instead. */
+                                    transmission->OnAddWriteAsync(forward0f(message_));
+                                }
+                            }
+
+                            if (!success) {
+                                Close();
+                            }
+
+                            callback_(success);
+                        });
+                    if (!handshaking) {
+                        transmission_->handshake_.reset();
+                    }
+                    return handshaking;
+                }
+
             private:
                 std::shared_ptr<SslSocketTransmission> transmission_;
             };
 
             std::shared_ptr<SslSocketTransmission> transmission = Reference::CastReference<SslSocketTransmission>(GetReference());
             std::shared_ptr<AsyncSslSocket> accept =
-                Reference::NewReference<AsyncSslSocket>(transmission, GetSocket(), ssl_context_, ssl_socket_, verify_peer_, host_, certificate_file_, certificate_key_file_, certificate_chain_file_, certificate_key_password_, ciphersuites_);
+                Reference::NewReference<AsyncSslSocket>(transmission, GetSocket(), ssl_context_, ssl_socket_, verify_peer_, host_, certificate_file_, certificate_key_file_, certificate_chain_file_, certificate_key_password_, ciphersuites_, session_ticket_key_file_, early_data_);
             return accept->HandshakeAsync(type, forward0f(callback));
         }
         
@@ -204,7 +306,61 @@ namespace frp {
                 return false;
             }
 
+            if (early_buffer_) {
+                return UnpackEarlyData(forward0f(callback));
+            }
+
+            if (ktls_stream_) {
+                return Transmission::Unpack(*ktls_stream_, forward0f(callback));
+            }
+
             return Transmission::Unpack(*ssl_socket_, forward0f(callback));
         }
+
+        bool SslSocketTransmission::UnpackEarlyData(const BOOST_ASIO_MOVE_ARG(ReadAsyncCallback) callback) noexcept {
+            if (!callback) {
+                return false;
+            }
+
+            /* frpc only sends whole frames as early data, a torn one means the peer is misbehaving. */
+            int remain = early_buffer_size_ - early_buffer_offset_;
+            Byte* p = early_buffer_.get() + early_buffer_offset_;
+            int length = remain < ETRANSMISSION_TSS ? -1 : (p[0] << 8 | p[1]);
+            if (length < 1 || length > (remain - ETRANSMISSION_TSS)) {
+                return false;
+            }
+
+            std::shared_ptr<Byte>& buffer = GetBuffer();
+            memcpy(buffer.get(), p + ETRANSMISSION_TSS, length);
+
+            early_buffer_offset_ += ETRANSMISSION_TSS + length;
+            if (early_buffer_offset_ >= early_buffer_size_) {
+                early_buffer_.reset();
+                early_buffer_size_ = 0;
+                early_buffer_offset_ = 0;
+            }
+
+            const std::shared_ptr<ITransmission> reference_ = GetReference();
+            const ReadAsyncCallback callback_ = BOOST_ASIO_MOVE_CAST(ReadAsyncCallback)(constantof(callback));
+            boost::asio::post(*GetContext(),
+                [reference_, this, callback_, length]() noexcept {
+                    callback_(GetBuffer(), length);
+                });
+            return true;
+        }
+
+        bool SslSocketTransmission::SetEarlyData(const std::shared_ptr<Byte>& buffer, int offset, int length) noexcept {
+            if (ssl_socket_) {
+                return false;
+            }
+
+            pmessage messages = Pack(buffer.get(), offset, length, WriteAsyncCallback());
+            if (!messages) {
+                return false;
+            }
+
+            early_message_ = std::move(messages);
+            return true;
+        }
     }
 }
\ No newline at end of file
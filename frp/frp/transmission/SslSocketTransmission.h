@@ -3,6 +3,11 @@
 #include <frp/transmission/Transmission.h>
 
 namespace frp {
+    namespace ssl {
+        class SslSocketStream;
+        class SslHandshake;
+    }
+
     namespace transmission {
         class SslSocketTransmission : public Transmission {
             typedef boost::asio::ssl::stream<boost::asio::ip::tcp::socket>  SslSocket;
@@ -18,7 +23,10 @@ namespace frp {
                 const std::string&                                          certificate_key_file,
                 const std::string&                                          certificate_chain_file,
                 const std::string&                                          certificate_key_password,
-                const std::string&                                          ciphersuites) noexcept;
+                const std::string&                                          ciphersuites,
+                const std::string&                                          session_ticket_key_file,
+                bool                                                        early_data,
+                bool                                                        ktls) noexcept;
 
         public:
             SslSocketTransmission(
@@ -27,7 +35,8 @@ namespace frp {
                 const std::shared_ptr<boost::asio::ip::tcp::socket>&        socket,
                 bool                                                        verify_peer,
                 const std::string&                                          host,
-                const std::string&                                          ciphersuites) noexcept;
+                const std::string&                                          ciphersuites,
+                bool                                                        ktls) noexcept;
             SslSocketTransmission(
                 const std::shared_ptr<frp::threading::Hosting>&             hosting, 
                 const std::shared_ptr<boost::asio::io_context>&             context, 
@@ -37,17 +46,24 @@ namespace frp {
                 const std::string&                                          certificate_key_file,
                 const std::string&                                          certificate_chain_file,
                 const std::string&                                          certificate_key_password,
-                const std::string&                                          ciphersuites) noexcept;
+                const std::string&                                          ciphersuites,
+                const std::string&                                          session_ticket_key_file,
+                bool                                                        early_data,
+                bool                                                        ktls) noexcept;
 
         public:
             virtual void                                                    Dispose() noexcept override;
             virtual bool                                                    HandshakeAsync(HandshakeType type, const BOOST_ASIO_MOVE_ARG(HandshakeAsyncCallback) callback) noexcept override;
             virtual bool                                                    WriteAsync(const std::shared_ptr<Byte>& buffer, int offset, int length, const BOOST_ASIO_MOVE_ARG(WriteAsyncCallback) callback) noexcept override;
             virtual bool                                                    ReadAsync(const BOOST_ASIO_MOVE_ARG(ReadAsyncCallback) callback) noexcept override;
+            virtual bool                                                    SetEarlyData(const std::shared_ptr<Byte>& buffer, int offset, int length) noexcept override;
 
         protected:
             virtual bool                                                    OnWriteAsync(const BOOST_ASIO_MOVE_ARG(pmessage) message) noexcept override;
 
+        private:
+            bool                                                            UnpackEarlyData(const BOOST_ASIO_MOVE_ARG(ReadAsyncCallback) callback) noexcept;
+
         private:
             std::atomic<bool>                                               disposed_;
             bool                                                            verify_peer_;
@@ -59,6 +75,15 @@ namespace frp {
             std::string                                                     certificate_chain_file_;
             std::string                                                     certificate_key_password_;
             std::string                                                     ciphersuites_;
+            std::string                                                     session_ticket_key_file_;
+            bool                                                            early_data_;
+            pmessage                                                        early_message_;
+            std::shared_ptr<Byte>                                           early_buffer_;
+            int                                                             early_buffer_size_;
+            int                                                             early_buffer_offset_;
+            bool                                                            ktls_;
+            std::shared_ptr<frp::ssl::SslSocketStream>                      ktls_stream_;
+            std::shared_ptr<frp::ssl::SslHandshake>                         handshake_;
         };
     }
 }
\ No newline at end of file
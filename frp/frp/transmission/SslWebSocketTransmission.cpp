@@ -1,7 +1,10 @@
 #include <frp/transmission/SslWebSocketTransmission.h>
 #include <frp/transmission/templates/SslSocket.hpp>
 #include <frp/transmission/templates/WebSocket.hpp>
+#include <frp/transmission/CompressionTransmission.h>
+#include <frp/ssl/SslHandshake.h>
 #include <frp/net/Socket.h>
+#include <frp/threading/Hosting.h>
 
 namespace frp {
     namespace transmission {
@@ -12,21 +15,26 @@ namespace frp {
             bool                                                        verify_peer,
             const std::string&                                          host,
             const std::string&                                          path,
+            const frp::configuration::WebSocketCompressionConfiguration& compression,
             const std::string&                                          certificate_file,
             const std::string&                                          certificate_key_file,
             const std::string&                                          certificate_chain_file,
             const std::string&                                          certificate_key_password,
-            const std::string&                                          ciphersuites) noexcept
+            const std::string&                                          ciphersuites,
+            const std::string&                                          session_ticket_key_file) noexcept
             : Transmission(hosting, context, socket)
             , disposed_(false)
             , verify_peer_(verify_peer)
             , host_(host)
             , path_(path)
+            , compression_(compression)
             , certificate_file_(certificate_file)
             , certificate_key_file_(certificate_key_file)
             , certificate_chain_file_(certificate_chain_file)
             , certificate_key_password_(certificate_key_password)
-            , ciphersuites_(ciphersuites) {
+            , ciphersuites_(ciphersuites)
+            , session_ticket_key_file_(session_ticket_key_file)
+            , early_data_(false) { /* The websocket upgrade has to complete before any frame, so there is nothing to send as 0-RTT. */
             
         }
 
@@ -37,6 +45,7 @@ namespace frp {
             bool                                                        verify_peer,
             const std::string&                                          host,
             const std::string&                                          path,
+            const frp::configuration::WebSocketCompressionConfiguration& compression,
             const std::string&                                          ciphersuites) noexcept 
             : SslWebSocketTransmission(
                 hosting,
@@ -45,11 +54,13 @@ namespace frp {
                 verify_peer,
                 host,
                 path,
+                compression,
                 "",
                 "",
                 "",
                 "",
-                ciphersuites) {
+                ciphersuites,
+                "") {
         
         }
 
@@ -59,11 +70,13 @@ namespace frp {
             const std::shared_ptr<boost::asio::ip::tcp::socket>&        socket,
             const std::string&                                          host,
             const std::string&                                          path,
+            const frp::configuration::WebSocketCompressionConfiguration& compression,
             const std::string&                                          certificate_file,
             const std::string&                                          certificate_key_file,
             const std::string&                                          certificate_chain_file,
             const std::string&                                          certificate_key_password,
-            const std::string&                                          ciphersuites) noexcept 
+            const std::string&                                          ciphersuites,
+            const std::string&                                          session_ticket_key_file) noexcept 
             : SslWebSocketTransmission(
                 hosting,
                 context,
@@ -71,11 +84,13 @@ namespace frp {
                 false,
                 host,
                 path,
+                compression,
                 certificate_file,
                 certificate_key_file,
                 certificate_chain_file,
                 certificate_key_password,
-                ciphersuites) {
+                ciphersuites,
+                session_ticket_key_file) {
         
         }
 
@@ -85,6 +100,11 @@ namespace frp {
                 if (!ssl_websocket_) {
                     Transmission::Dispose();
                 }
+                elif(handshake_) {
+                    /* The TLS handshake is still with the workers, there is no websocket to close yet. */
+                    Transmission::Dispose();
+                    frp::net::Socket::Closesocket(ssl_websocket_->next_layer().next_layer());
+                }
                 else {
                     ssl_websocket_->async_close(boost::beast::websocket::close_code::normal,
                         [reference, this](const boost::system::error_code& ec_) noexcept {
@@ -107,8 +127,8 @@ namespace frp {
 
             class AcceptSslvWebSocket final : public frp::transmission::templates::WebSocket<SslvWebSocket> {
             public:
-                inline AcceptSslvWebSocket(const std::shared_ptr<SslWebSocketTransmission>& transmission, SslvWebSocket& websocket, std::string& host, std::string& path) noexcept
-                    : WebSocket(websocket, host, path)
+                inline AcceptSslvWebSocket(const std::shared_ptr<SslWebSocketTransmission>& transmission, SslvWebSocket& websocket, std::string& host, std::string& path, const WebSocketCompressionConfiguration& compression) noexcept
+                    : WebSocket(websocket, host, path, compression)
                     , transmission_(transmission) {
 
                 }
@@ -150,8 +170,10 @@ namespace frp {
                     std::string& certificate_key_file,
                     std::string& certificate_chain_file,
                     std::string& certificate_key_password,
-                    std::string& ciphersuites) noexcept
-                    : SslSocket(tcp_socket, ssl_context, ssl_websocket, verify_peer, host, certificate_file, certificate_key_file, certificate_chain_file, certificate_key_password, ciphersuites)
+                    std::string& ciphersuites,
+                    std::string& session_ticket_key_file,
+                    bool& early_data) noexcept
+                    : SslSocket(tcp_socket, ssl_context, ssl_websocket, verify_peer, host, certificate_file, certificate_key_file, certificate_chain_file, certificate_key_password, ciphersuites, session_ticket_key_file, early_data)
                     , path_(path)
                     , transmission_(transmission) {
 
@@ -170,7 +192,7 @@ namespace frp {
                 inline bool  PerformWebSocketHandshakeAsync(HandshakeType type, const BOOST_ASIO_MOVE_ARG(HandshakeAsyncCallback) callback) noexcept {
                     SslvWebSocketPtr& ssl_websocket_ = GetSslSocket();
                     std::shared_ptr<AcceptSslvWebSocket> accept =
-                        NewReference<AcceptSslvWebSocket>(transmission_, *ssl_websocket_, host_, path_);
+                        NewReference<AcceptSslvWebSocket>(transmission_, *ssl_websocket_, host_, path_, transmission_->compression_);
                     return accept->HandshakeAsync(type, forward0f(callback));
                 }
                 virtual SSL* GetSslHandle() noexcept override {
@@ -188,6 +210,10 @@ namespace frp {
                     // Perform the SSL handshake.
                     SslvWebSocketPtr& ssl_websocket_ = GetSslSocket();
                     SslvTcpSocket& ssl_socket_ = ssl_websocket_->next_layer();
+                    if (transmission_->GetHosting()->GetWorkers()) {
+                        return PerformSslSocketHandshakeAsync(type, forward0f(callback_));
+                    }
+
                     ssl_socket_.async_handshake(handshakeType,
                         [reference_, this, type, callback_](const boost::system::error_code& ec) noexcept {
                             bool success = ec ? false : true;
@@ -202,6 +228,42 @@ namespace frp {
                         });
                     return true;
                 }
+                inline bool PerformSslSocketHandshakeAsync(HandshakeType type, const BOOST_ASIO_MOVE_ARG(HandshakeAsyncCallback) callback) noexcept {
+                    SslvTcpSocket& ssl_socket_ = GetSslSocket()->next_layer();
+                    std::shared_ptr<frp::ssl::SslHandshake> handshake = NewReference<frp::ssl::SslHandshake>(ssl_socket_.native_handle(), ssl_socket_.next_layer());
+                    if (!handshake) {
+                        return false;
+                    }
+
+                    handshake->SetWorkers(transmission_->GetHosting()->GetWorkers());
+                    transmission_->handshake_ = handshake;
+
+                    const std::shared_ptr<Reference> reference_ = GetReference();
+                    const HandshakeAsyncCallback callback_ = BOOST_ASIO_MOVE_CAST(HandshakeAsyncCallback)(constantof(callback));
+                    bool handshaking = handshake->HandshakeAsync(type == HandshakeType::HandshakeType_Client, NULL, 0,
+                        [reference_, this, handshake, type, callback_](bool success) noexcept {
+                            const std::shared_ptr<SslWebSocketTransmission> transmission = transmission_;
+                            if (transmission) {
+                                transmission->handshake_.reset();
+                            }
+
+                            if (!transmission || transmission->disposed_) {
+                                success = false;
+                            }
+                            elif(success) {
+                                success = PerformWebSocketHandshakeAsync(type, forward0f(callback_));
+                            }
+
+                            if (!success) {
+                                Close();
+                                callback_(success);
+                            }
+                        });
+                    if (!handshaking) {
+                        transmission_->handshake_.reset();
+                    }
+                    return handshaking;
+                }
                 
             private:
                 std::string& path_;
@@ -210,7 +272,7 @@ namespace frp {
 
             std::shared_ptr<SslWebSocketTransmission> transmission = Reference::CastReference<SslWebSocketTransmission>(GetReference());
             std::shared_ptr<AsyncSslvWebSocket> accept =
-                Reference::NewReference<AsyncSslvWebSocket>(transmission, GetSocket(), ssl_context_, ssl_websocket_, verify_peer_, host_, path_, certificate_file_, certificate_key_file_, certificate_chain_file_, certificate_key_password_, ciphersuites_);
+                Reference::NewReference<AsyncSslvWebSocket>(transmission, GetSocket(), ssl_context_, ssl_websocket_, verify_peer_, host_, path_, certificate_file_, certificate_key_file_, certificate_chain_file_, certificate_key_password_, ciphersuites_, session_ticket_key_file_, early_data_);
             return accept->HandshakeAsync(type, forward0f(callback));
         }
 
@@ -218,6 +280,9 @@ namespace frp {
             const std::shared_ptr<ITransmission> reference = GetReference();
             const pmessage messages = BOOST_ASIO_MOVE_CAST(pmessage)(constantof(message));
 
+            /* Small and already compressed packets go out as they are, deflating them only costs time. */
+            frp::transmission::templates::WebSocketCompress(*ssl_websocket_, compression_.Enabled && messages->packet_size >= compression_.Threshold &&
+                !CompressionTransmission::IsIncompressible(messages->packet.get(), messages->packet_size));
             ssl_websocket_->async_write(boost::asio::buffer(messages->packet.get(), messages->packet_size),
                 [reference, this, messages](const boost::system::error_code& ec, size_t sz) noexcept {
                     bool success = ec ? false : true;
@@ -239,7 +304,7 @@ namespace frp {
                 return false;
             }
 
-            pmessage messages = Pack(buffer.get(), offset, length, forward0f(callback));
+            pmessage messages = Frame(buffer.get(), offset, length, forward0f(callback));
             if (!messages) {
                 return false;
             }
@@ -253,7 +318,7 @@ namespace frp {
                 return false;
             }
 
-            return Transmission::Unpack(*ssl_websocket_, forward0f(callback));
+            return Transmission::UnpackMessage(*ssl_websocket_, forward0f(callback));
         }
     }
 }
\ No newline at end of file
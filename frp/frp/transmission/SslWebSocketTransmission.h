@@ -1,8 +1,13 @@
 #pragma once
 
 #include <frp/transmission/Transmission.h>
+#include <frp/configuration/WebSocketConfiguration.h>
 
 namespace frp {
+    namespace ssl {
+        class SslHandshake;
+    }
+
     namespace transmission {
         class SslWebSocketTransmission : public Transmission {
             typedef boost::asio::ip::tcp::socket                            AsioTcpSocket;
@@ -17,11 +22,13 @@ namespace frp {
                 bool                                                        verify_peer,
                 const std::string&                                          host,
                 const std::string&                                          path,
+                const frp::configuration::WebSocketCompressionConfiguration& compression,
                 const std::string&                                          certificate_file,
                 const std::string&                                          certificate_key_file,
                 const std::string&                                          certificate_chain_file,
                 const std::string&                                          certificate_key_password,
-                const std::string&                                          ciphersuites) noexcept;
+                const std::string&                                          ciphersuites,
+                const std::string&                                          session_ticket_key_file) noexcept;
 
         public:
             SslWebSocketTransmission(
@@ -31,6 +38,7 @@ namespace frp {
                 bool                                                        verify_peer,
                 const std::string&                                          host,
                 const std::string&                                          path,
+                const frp::configuration::WebSocketCompressionConfiguration& compression,
                 const std::string&                                          ciphersuites) noexcept;
             SslWebSocketTransmission(
                 const std::shared_ptr<frp::threading::Hosting>&             hosting, 
@@ -38,11 +46,13 @@ namespace frp {
                 const std::shared_ptr<boost::asio::ip::tcp::socket>&        socket,
                 const std::string&                                          host,
                 const std::string&                                          path,
+                const frp::configuration::WebSocketCompressionConfiguration& compression,
                 const std::string&                                          certificate_file,
                 const std::string&                                          certificate_key_file,
                 const std::string&                                          certificate_chain_file,
                 const std::string&                                          certificate_key_password,
-                const std::string&                                          ciphersuites) noexcept;
+                const std::string&                                          ciphersuites,
+                const std::string&                                          session_ticket_key_file) noexcept;
 
         public:
             virtual void                                                    Dispose() noexcept override;
@@ -60,11 +70,15 @@ namespace frp {
             bool                                                            verify_peer_;
             std::string                                                     host_;
             std::string                                                     path_;
+            frp::configuration::WebSocketCompressionConfiguration           compression_;
             std::string                                                     certificate_file_;
             std::string                                                     certificate_key_file_;
             std::string                                                     certificate_chain_file_;
             std::string                                                     certificate_key_password_;
             std::string                                                     ciphersuites_;
+            std::string                                                     session_ticket_key_file_;
+            bool                                                            early_data_;
+            std::shared_ptr<frp::ssl::SslHandshake>                         handshake_;
         };
     }
 }
\ No newline at end of file
@@ -138,17 +138,46 @@ namespace frp {
             return OnWriteAsync(BOOST_ASIO_MOVE_CAST(pmessage)(message));
         }
 
-        Transmission::pmessage Transmission::Pack(const void* buffer, int offset, int length, const BOOST_ASIO_MOVE_ARG(WriteAsyncCallback) callback) noexcept {
+        Transmission::pmessage Transmission::Frame(const void* buffer, int offset, int length, const BOOST_ASIO_MOVE_ARG(WriteAsyncCallback) callback) noexcept {
             if (!buffer || offset < 0 || length < 1 || length > ETRANSMISSION_MSS) {
                 return NULL;
             }
 
-            int packet_size_ = ETRANSMISSION_TSS + length;
+            /* For the message oriented carriers (websocket), the frame goes out as it is. */
+            std::shared_ptr<Byte> packet_ = make_shared_alloc<Byte>(length);
+            if (!packet_) {
+                return NULL;
+            }
+
+            memcpy(packet_.get(), ((Byte*)buffer) + offset, length);
+
+            pmessage messages = make_shared_object<message>();
+            messages->packet = packet_;
+            messages->packet_size = length;
+            messages->callback = BOOST_ASIO_MOVE_CAST(WriteAsyncCallback)(constantof(callback));
+            return messages;
+        }
+
+        Transmission::pmessage Transmission::Pack(const void* buffer, int offset, int length, const BOOST_ASIO_MOVE_ARG(WriteAsyncCallback) callback) noexcept {
+            return Pack(buffer, offset, length, 0, forward0f(callback));
+        }
+
+        Transmission::pmessage Transmission::Pack(const void* buffer, int offset, int length, int padding, const BOOST_ASIO_MOVE_ARG(WriteAsyncCallback) callback) noexcept {
+            if (!buffer || offset < 0 || length < 1 || padding < 0 || (length + padding) > ETRANSMISSION_MSS) {
+                return NULL;
+            }
+
+            /* The padding bytes trail the payload and are left for the caller to fill in (e.g. an AEAD tag). */
+            int frame_size_ = length + padding;
+            int packet_size_ = ETRANSMISSION_TSS + frame_size_;
             std::shared_ptr<Byte> packet_ = make_shared_alloc<Byte>(packet_size_);
+            if (!packet_) {
+                return NULL;
+            }
 
             Byte* p_ = packet_.get();
-            p_[0] = (Byte)(length >> 8);
-            p_[1] = (Byte)(length);
+            p_[0] = (Byte)(frame_size_ >> 8);
+            p_[1] = (Byte)(frame_size_);
             memcpy(p_ + ETRANSMISSION_TSS, ((Byte*)buffer) + offset, length);
 
             pmessage messages = make_shared_object<message>();
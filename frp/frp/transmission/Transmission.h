@@ -97,7 +97,45 @@ namespace frp {
                     });
                 return true;
             }
+            template<typename WebSocketStream>
+            bool                                                    UnpackMessage(WebSocketStream& websocket, const BOOST_ASIO_MOVE_ARG(ReadAsyncCallback) callback) noexcept {
+                if (!callback) {
+                    return false;
+                }
+
+                /* The websocket message already delimits the frame, there is no length header inside it. */
+                const ReadAsyncCallback callback_ = BOOST_ASIO_MOVE_CAST(ReadAsyncCallback)(constantof(callback));
+                return UnpackMessage(addressof(websocket), 0, callback_);
+            }
+            template<typename WebSocketStream>
+            bool                                                    UnpackMessage(WebSocketStream* websocket, int offset, const ReadAsyncCallback& callback) noexcept {
+                const std::shared_ptr<ITransmission> reference_ = GetReference();
+                const ReadAsyncCallback callback_ = callback;
+
+                /* Mostly one read, a message only comes in pieces when the peer fragmented it. */
+                websocket->async_read_some(boost::asio::buffer(buffer_.get() + offset, ETRANSMISSION_MSS - offset),
+                    [reference_, this, websocket, offset, callback_](const boost::system::error_code& ec, std::size_t sz) noexcept {
+                        int length = ec ? -1 : offset + (int)sz;
+                        if (length > 0 && !websocket->is_message_done()) {
+                            if (length < ETRANSMISSION_MSS && UnpackMessage(websocket, length, callback_)) {
+                                return;
+                            }
+                            length = -1;
+                        }
+
+                        if (length < 1) {
+                            Close();
+                            callback_(NULL, length);
+                        }
+                        else {
+                            callback_(buffer_, length);
+                        }
+                    });
+                return true;
+            }
+            static pmessage                                         Frame(const void* buffer, int offset, int length, const BOOST_ASIO_MOVE_ARG(WriteAsyncCallback) callback) noexcept;
             static pmessage                                         Pack(const void* buffer, int offset, int length, const BOOST_ASIO_MOVE_ARG(WriteAsyncCallback) callback) noexcept;
+            static pmessage                                         Pack(const void* buffer, int offset, int length, int padding, const BOOST_ASIO_MOVE_ARG(WriteAsyncCallback) callback) noexcept;
 
         private:
             std::atomic<bool>                                       disposed_;
@@ -1,5 +1,6 @@
 #include <frp/transmission/WebSocketTransmission.h>
 #include <frp/transmission/templates/WebSocket.hpp>
+#include <frp/transmission/CompressionTransmission.h>
 #include <frp/net/Ipep.h>
 #include <frp/net/IPEndPoint.h>
 
@@ -11,11 +12,13 @@ namespace frp {
             const std::shared_ptr<boost::asio::io_context>&         context,
             const std::shared_ptr<boost::asio::ip::tcp::socket>&    socket,
             const std::string&                                      host,
-            const std::string&                                      path) noexcept
+            const std::string&                                      path,
+            const frp::configuration::WebSocketCompressionConfiguration& compression) noexcept
             : Transmission(hosting, context, socket)
             , disposed_(false)
             , host_(host)
             , path_(path)
+            , compression_(compression)
             , websocket_(std::move(*socket)) {
 
         }
@@ -27,8 +30,8 @@ namespace frp {
 
             class AcceptWebSocket final : public frp::transmission::templates::WebSocket<AsioWebSocket> {
             public:
-                inline AcceptWebSocket(const std::shared_ptr<WebSocketTransmission>& transmission, AsioWebSocket& websocket, std::string& host, std::string& path) noexcept
-                    : WebSocket(websocket, host, path)
+                inline AcceptWebSocket(const std::shared_ptr<WebSocketTransmission>& transmission, AsioWebSocket& websocket, std::string& host, std::string& path, const WebSocketCompressionConfiguration& compression) noexcept
+                    : WebSocket(websocket, host, path, compression)
                     , transmission_(transmission) {
 
                 }
@@ -59,7 +62,7 @@ namespace frp {
 
             std::shared_ptr<WebSocketTransmission> transmission = Reference::CastReference<WebSocketTransmission>(GetReference());
             std::shared_ptr<AcceptWebSocket> accept =
-                Reference::NewReference<AcceptWebSocket>(transmission, websocket_, host_, path_);
+                Reference::NewReference<AcceptWebSocket>(transmission, websocket_, host_, path_, compression_);
             return accept->HandshakeAsync(type, forward0f(callback));
         }
 
@@ -181,6 +184,9 @@ namespace frp {
             const std::shared_ptr<ITransmission> reference = GetReference();
             const pmessage messages = BOOST_ASIO_MOVE_CAST(pmessage)(constantof(message));
 
+            /* Small and already compressed packets go out as they are, deflating them only costs time. */
+            frp::transmission::templates::WebSocketCompress(websocket_, compression_.Enabled && messages->packet_size >= compression_.Threshold &&
+                !CompressionTransmission::IsIncompressible(messages->packet.get(), messages->packet_size));
             websocket_.async_write(boost::asio::buffer(messages->packet.get(), messages->packet_size),
                 [reference, this, messages](const boost::system::error_code& ec, size_t sz) noexcept {
                     bool success = ec ? false :true;
@@ -202,7 +208,7 @@ namespace frp {
                 return false;
             }
 
-            return Transmission::Unpack(websocket_, forward0f(callback));
+            return Transmission::UnpackMessage(websocket_, forward0f(callback));
         }
 
         void WebSocketTransmission::Dispose() noexcept {
@@ -220,7 +226,7 @@ namespace frp {
                 return false;
             }
 
-            pmessage messages = Pack(buffer.get(), offset, length, forward0f(callback));
+            pmessage messages = Frame(buffer.get(), offset, length, forward0f(callback));
             if (!messages) {
                 return false;
             }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <frp/transmission/Transmission.h>
+#include <frp/configuration/WebSocketConfiguration.h>
 
 namespace frp {
     namespace transmission {
@@ -14,7 +15,8 @@ namespace frp {
                 const std::shared_ptr<boost::asio::io_context>&         context, 
                 const std::shared_ptr<boost::asio::ip::tcp::socket>&    socket,
                 const std::string&                                      host,
-                const std::string&                                      path) noexcept;
+                const std::string&                                      path,
+                const frp::configuration::WebSocketCompressionConfiguration& compression) noexcept;
         
         public:
             virtual void                                                Dispose() noexcept override;
@@ -38,6 +40,7 @@ namespace frp {
             std::atomic<bool>                                           disposed_;
             std::string                                                 host_;
             std::string                                                 path_;
+            frp::configuration::WebSocketCompressionConfiguration       compression_;
             AsioWebSocket                                               websocket_;
         };
     }
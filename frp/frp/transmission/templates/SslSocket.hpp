@@ -24,7 +24,9 @@ namespace frp {
                     std::string&                                    certificate_key_file,
                     std::string&                                    certificate_chain_file,
                     std::string&                                    certificate_key_password,
-                    std::string&                                    ciphersuites) noexcept 
+                    std::string&                                    ciphersuites,
+                    std::string&                                    session_ticket_key_file,
+                    bool&                                           early_data) noexcept 
                     : tcp_socket_(tcp_socket)
                     , ssl_context_(ssl_context)
                     , ssl_socket_(ssl_socket)
@@ -34,7 +36,9 @@ namespace frp {
                     , certificate_key_file_(certificate_key_file)
                     , certificate_chain_file_(certificate_chain_file)
                     , certificate_key_password_(certificate_key_password)
-                    , ciphersuites_(ciphersuites) {
+                    , ciphersuites_(ciphersuites)
+                    , session_ticket_key_file_(session_ticket_key_file)
+                    , early_data_(early_data) {
                     
                 }
 
@@ -58,14 +62,22 @@ namespace frp {
                         return false;
                     }
 
+                    // Sessions are cached per frps, the endpoint must be read before the socket moves into the ssl stream.
+                    std::string session_key;
                     if (type == HandshakeType::HandshakeType_Client) {
-                        ssl_context_ = frp::ssl::SSL::CreateClientSslContext(frp::ssl::SSL::SSL_METHOD::tlsv13, verify_peer_, ciphersuites_);
+                        ssl_context_ = frp::ssl::SSL::GetClientSslContext(frp::ssl::SSL::SSL_METHOD::tlsv13, verify_peer_, ciphersuites_);
+
+                        boost::system::error_code ec;
+                        boost::asio::ip::tcp::endpoint remoteEP = tcpSocket->remote_endpoint(ec);
+                        if (!ec) {
+                            session_key = host_ + "@" + remoteEP.address().to_string() + ":" + std::to_string(remoteEP.port());
+                        }
                     }
                     elif(certificate_file_.empty() || certificate_key_file_.empty() || certificate_chain_file_.empty()) {
                         return false;
                     }
                     else {
-                        ssl_context_ = frp::ssl::SSL::CreateServerSslContext(frp::ssl::SSL::SSL_METHOD::tlsv13, certificate_file_, certificate_key_file_, certificate_chain_file_, certificate_key_password_, ciphersuites_);
+                        ssl_context_ = frp::ssl::SSL::GetServerSslContext(frp::ssl::SSL::SSL_METHOD::tlsv13, certificate_file_, certificate_key_file_, certificate_chain_file_, certificate_key_password_, ciphersuites_, session_ticket_key_file_, early_data_);
                     }
 
                     boost::system::error_code ec;
@@ -85,6 +97,9 @@ namespace frp {
                         }
                     }
 
+                    if (session_key.size()) {
+                        frp::ssl::SSL::SetClientSession(GetSslHandle(), session_key);
+                    }
                     return PerformSslHandshakeAsync(type, forward0f(callback));
                 }
 
@@ -106,6 +121,8 @@ namespace frp {
                 std::string&                                        certificate_chain_file_;
                 std::string&                                        certificate_key_password_;
                 std::string&                                        ciphersuites_;
+                std::string&                                        session_ticket_key_file_;
+                bool&                                               early_data_;
             };
         }
     }
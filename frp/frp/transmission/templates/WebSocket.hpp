@@ -2,10 +2,25 @@
 
 #include <frp/IDisposable.h>
 #include <frp/net/IPEndPoint.h>
+#include <frp/configuration/WebSocketConfiguration.h>
 
 namespace frp {
     namespace transmission {
         namespace templates {
+            /* Only newer beast can switch compression per message, older ones compress every message once it is negotiated. */
+            template<class T>
+            inline auto                                             WebSocketCompress(T& websocket, bool compress, int) noexcept -> decltype(websocket.compress(compress), void()) {
+                websocket.compress(compress);
+            }
+            template<class T>
+            inline void                                             WebSocketCompress(T& websocket, bool compress, long) noexcept {
+
+            }
+            template<class T>
+            inline void                                             WebSocketCompress(T& websocket, bool compress) noexcept {
+                WebSocketCompress(websocket, compress, 0);
+            }
+
             template<class T>
             class WebSocket : public IDisposable {
             public:
@@ -15,16 +30,32 @@ namespace frp {
                 typedef frp::net::IPEndPoint                        IPEndPoint;
                 typedef boost::beast::http::dynamic_body            dynamic_body;
                 typedef boost::beast::http::request<dynamic_body>   http_request;
+                typedef frp::configuration::WebSocketCompressionConfiguration WebSocketCompressionConfiguration;
 
             public:
                 inline WebSocket(
                     T&                                              websocket,
                     std::string&                                    host,
-                    std::string&                                    path) noexcept 
+                    std::string&                                    path,
+                    const WebSocketCompressionConfiguration&        compression) noexcept 
                     : host_(host)
                     , path_(path)
                     , websocket_(websocket) {
                     websocket_.binary(true);
+                    websocket_.read_message_max(frp::threading::Hosting::BufferSize); /* A message is a frame, none is ever larger. */
+
+                    /* The client offers it in the upgrade request, the server takes it only if enabled as well, either way the peers agree on it. */
+                    if (compression.Enabled) {
+                        boost::beast::websocket::permessage_deflate deflate;
+                        deflate.server_enable = true;
+                        deflate.client_enable = true;
+                        deflate.server_max_window_bits = compression.WindowBits;
+                        deflate.client_max_window_bits = compression.WindowBits;
+                        deflate.server_no_context_takeover = compression.NoContextTakeover;
+                        deflate.client_no_context_takeover = compression.NoContextTakeover;
+                        deflate.memLevel = compression.MemLevel;
+                        websocket_.set_option(deflate);
+                    }
                 }
 
             protected:
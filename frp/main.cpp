@@ -98,6 +98,7 @@ int main(int argc, const char* argv[]) noexcept {
     frp::cryptography::Encryptor::Initialize(); /* Prepare the OpenSSL cryptography library environment. */
 
     std::shared_ptr<Hosting> hosting = Reference::NewReference<Hosting>();
+    hosting->OpenWorkers(configuration->Workers); /* TLS handshakes and other CPU heavy work leave the hosting loop. */
     hosting->Run(
         [configuration, hosting]() noexcept {
             auto protocol = [](AppConfiguration* config) noexcept {
@@ -108,13 +109,15 @@ int main(int argc, const char* argv[]) noexcept {
                 case AppConfiguration::ProtocolType_TLS:
                     return "tls";
                 case AppConfiguration::ProtocolType_Encryptor:
-                    return "encryptor";
+                    return config->Protocols.Encryptor.Aead ? "encryptor+aead" : "encryptor";
                 case AppConfiguration::ProtocolType_WebSocket:
                     return "websocket";
                 case AppConfiguration::ProtocolType_WebSocket_SSL:
                     return "websocket+ssl";
                 case AppConfiguration::ProtocolType_WebSocket_TLS:
                     return "websocket+tls";
+                case AppConfiguration::ProtocolType_ReliableUdp:
+                    return "rudp";
                 default:
                     return "tcp";
                 };
@@ -155,4 +158,4 @@ int main(int argc, const char* argv[]) noexcept {
             }
         });
     return 0;
-}
+}
\ No newline at end of file